@@ -0,0 +1,727 @@
+//
+//  XNCoreTests.c
+//  Animations
+//
+//  Created by Grant Paul on 1/19/13.
+//  Copyright (c) 2013 Xuzz Productions, LLC. All rights reserved.
+//
+
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "XNCoreBezier.h"
+#include "XNCoreComponents.h"
+#include "XNCoreDecay.h"
+#include "XNCoreElastic.h"
+#include "XNCoreScroll.h"
+#include "XNCoreSpring.h"
+#include "XNCoreTiming.h"
+#include "XNCoreTrace.h"
+
+// The reference implementations below are the Objective-C timing functions as
+// they were before moving to the core, with CGFloat as float and the same
+// single precision math calls, so the core is checked against the results
+// the Objective-C classes used to produce. M_E isn't standard C, so their
+// powf(M_E, x) is written as expf(x).
+
+static int XNCoreTestsFailures = 0;
+
+static void XNCoreTestsExpect(const char *name, double actual, double expected, double tolerance) {
+    if (!(fabs(actual - expected) <= tolerance)) {
+        fprintf(stderr, "FAIL %s: got %.9g, expected %.9g (tolerance %g)\n", name, actual, expected, tolerance);
+        XNCoreTestsFailures += 1;
+    }
+}
+
+static void XNCoreTestsExpectTrue(const char *name, bool value) {
+    if (!value) {
+        fprintf(stderr, "FAIL %s\n", name);
+        XNCoreTestsFailures += 1;
+    }
+}
+
+// Bezier
+
+#define nCr(n, r) round(exp((lgamma(n+1)) - (lgamma(r+1) + lgamma(n-r+1))))
+
+static void XNCoreTestsReferenceBezierAtTime(const float *points, unsigned n, float t, float *outX, float *outY, float *outDX) {
+    float x = 0, y = 0, dx = 0;
+
+    for (unsigned i = 0; i <= n; i++) {
+        float b = nCr(n, i) * powf(t, i) * powf(1 - t, n - i);
+        x += points[i * 2] * b;
+        y += points[i * 2 + 1] * b;
+    }
+
+    for (unsigned i = 0; i <= (n - 1); i++) {
+        float b = nCr((n - 1), i) * powf(t, i) * powf(1 - t, (n - 1) - i);
+        dx += n * (points[(i + 1) * 2] - points[i * 2]) * b;
+    }
+
+    *outX = x;
+    *outY = y;
+    *outDX = dx;
+}
+
+static float XNCoreTestsReferenceBezierSolve(const float *points, unsigned n, float t) {
+    float x = 0, y = 0, dx = 0;
+    float a = t;
+
+    for (int i = 0; i < 4; i++) {
+        XNCoreTestsReferenceBezierAtTime(points, n, a, &x, &y, &dx);
+
+        if (dx == 0) {
+            break;
+        }
+
+        a = a - ((x - t) / dx);
+    }
+
+    return y;
+}
+
+static void XNCoreTestsBezier(void) {
+    const double easeInOut[4] = { 0.42, 0.0, 0.58, 1.0 };
+    const double easeIn[4] = { 0.42, 0.0, 1.0, 1.0 };
+    const double quadratic[2] = { 0.25, 0.9 };
+
+    const float easeInOutReference[8] = { 0, 0, 0.42f, 0.0f, 0.58f, 1.0f, 1, 1 };
+    const float easeInReference[8] = { 0, 0, 0.42f, 0.0f, 1.0f, 1.0f, 1, 1 };
+    const float quadraticReference[6] = { 0, 0, 0.25f, 0.9f, 1, 1 };
+
+    for (int i = 1; i < 100; i++) {
+        double t = i / 100.0;
+
+        XNCoreTestsExpect("bezier ease in-out solve", XNCoreBezierSolve(easeInOut, 2, t), XNCoreTestsReferenceBezierSolve(easeInOutReference, 3, t), 1e-5);
+        XNCoreTestsExpect("bezier ease in solve", XNCoreBezierSolve(easeIn, 2, t), XNCoreTestsReferenceBezierSolve(easeInReference, 3, t), 1e-5);
+        XNCoreTestsExpect("bezier quadratic solve", XNCoreBezierSolve(quadratic, 1, t), XNCoreTestsReferenceBezierSolve(quadraticReference, 2, t), 1e-5);
+    }
+
+    XNCoreBezierCurve curve;
+    XNCoreBezierCurveInit(&curve, easeInOut, 2);
+
+    bool complete = true;
+    XNCoreTestsExpect("bezier start", XNCoreBezierCurveEvaluate(&curve, 0.0, &complete), 0.0, 0.0);
+    XNCoreTestsExpectTrue("bezier start incomplete", !complete);
+    XNCoreTestsExpect("bezier middle", XNCoreBezierCurveEvaluate(&curve, 0.5, &complete), 0.5, 1e-6);
+    XNCoreTestsExpect("bezier end", XNCoreBezierCurveEvaluate(&curve, 1.0, &complete), 1.0, 0.0);
+    XNCoreTestsExpectTrue("bezier end complete", complete);
+
+    // Between samples, interpolation should stay close to the exact curve.
+    for (int i = 1; i < 1000; i++) {
+        double t = i / 1000.0;
+        XNCoreTestsExpect("bezier interpolation", XNCoreBezierCurveEvaluate(&curve, t, &complete), XNCoreBezierSolve(easeInOut, 2, t), 1e-4);
+    }
+
+    double durations[2] = { 1.0, 2.0 };
+    double from[2] = { 0.0, 100.0 };
+    double to[2] = { 10.0, 50.0 };
+    double positions[2];
+
+    XNCoreBezierCurveEvaluateBatch(&curve, 2, 1.0, durations, from, to, positions, &complete);
+    XNCoreTestsExpect("bezier batch first", positions[0], 10.0, 0.0);
+    XNCoreTestsExpect("bezier batch second", positions[1], 75.0, 1e-4);
+    XNCoreTestsExpectTrue("bezier batch incomplete", !complete);
+}
+
+// Spring
+
+static float XNCoreTestsReferenceSpring(float _k, float _b, float _m, float elapsed, float velocity, float restDistance, float restVelocity, bool *outComplete) {
+    float v0 = -velocity;
+    float x0 = 1.0;
+
+    float t = elapsed;
+
+    float w0 = sqrtf(_k / _m);
+
+    float zeta = _b / (2 * sqrtf(_m * _k));
+    float x = 0;
+    float dx = 0;
+
+    if (zeta < 1.0f) {
+        float wD = w0 * sqrtf(1 - zeta * zeta);
+
+        float A = x0;
+        float B = (zeta * w0 * x0 + v0) / wD;
+
+        float envelope = expf(-zeta * w0 * t);
+        x = envelope * (A * cos(wD * t) + B * sin(wD * t));
+        dx = envelope * ((B * wD - zeta * w0 * A) * cos(wD * t) - (A * wD + zeta * w0 * B) * sin(wD * t));
+    }
+
+    bool resting = (fabs(x) <= restDistance && fabs(dx) <= restVelocity);
+
+    x = 1.0 - x;
+
+    if (resting) {
+        *outComplete = true;
+        return 1.0;
+    } else {
+        *outComplete = false;
+        return x;
+    }
+}
+
+// Whatever the damping, a spring starts at the from value with the velocity
+// it was given, and ends up at the to value. These don't depend on the old
+// implementation, so they also cover the damping cases it got wrong.
+static void XNCoreTestsSpringInvariants(void) {
+    // Underdamped, then critically damped and overdamped with unit and
+    // non-unit masses.
+    const XNCoreSpring springs[5] = { { 273.0, 20.0, 1.0 }, { 100.0, 20.0, 1.0 }, { 50.0, 20.0, 2.0 }, { 100.0, 40.0, 1.0 }, { 50.0, 40.0, 2.0 } };
+    const double velocities[3] = { 0.0, 2.5, -4.0 };
+    const double h = 1e-6;
+
+    for (int s = 0; s < 5; s++) {
+        for (int v = 0; v < 3; v++) {
+            bool complete;
+
+            // No rest thresholds, so nothing snaps to the end early.
+            double start = XNCoreSpringEvaluate(&springs[s], 0.0, velocities[v], 0.0, 0.0, &complete);
+            double next = XNCoreSpringEvaluate(&springs[s], h, velocities[v], 0.0, 0.0, &complete);
+            double end = XNCoreSpringEvaluate(&springs[s], 20.0, velocities[v], 0.0, 0.0, &complete);
+
+            XNCoreTestsExpect("spring starts at from", start, 0.0, 1e-9);
+            XNCoreTestsExpect("spring starts at velocity", (next - start) / h, velocities[v], 1e-3);
+            XNCoreTestsExpect("spring ends at to", end, 1.0, 1e-6);
+        }
+    }
+
+    // Just either side of critical damping, a spring moves like a critically
+    // damped one. Solved as overdamped, it cancels two huge terms and is off
+    // by orders of magnitude more than its damping is.
+    const XNCoreSpring critical = { 100.0, 20.0, 1.0 };
+    const XNCoreSpring nearCritical[3] = { { 100.0, 20.0 * (1.0 - 1e-14), 1.0 }, { 100.0, 20.0 * (1.0 + 1e-14), 1.0 }, { 100.0, 20.0 * (1.0 + 1e-15), 1.0 } };
+
+    for (int s = 0; s < 3; s++) {
+        for (int v = 0; v < 3; v++) {
+            for (int i = 0; i <= 120; i++) {
+                double t = i / 60.0;
+                bool complete;
+
+                double expected = XNCoreSpringEvaluate(&critical, t, velocities[v], 0.0, 0.0, &complete);
+                double actual = XNCoreSpringEvaluate(&nearCritical[s], t, velocities[v], 0.0, 0.0, &complete);
+                XNCoreTestsExpect("spring near critical", actual, expected, 1e-12);
+            }
+        }
+    }
+}
+
+static void XNCoreTestsSpring(void) {
+    // Only underdamped springs are compared: the Objective-C classes had the
+    // critically damped and overdamped cases wrong, and the invariants below
+    // check those instead.
+    const XNCoreSpring springs[2] = { { 273.0, 20.0, 1.0 }, { 150.0, 12.0, 2.0 } };
+    const double velocities[3] = { 0.0, 2.5, -4.0 };
+
+    for (int s = 0; s < 2; s++) {
+        for (int v = 0; v < 3; v++) {
+            for (int i = 0; i <= 120; i++) {
+                double t = i / 60.0;
+                bool complete, referenceComplete;
+
+                double x = XNCoreSpringEvaluate(&springs[s], t, velocities[v], 0.001, 0.06, &complete);
+                float reference = XNCoreTestsReferenceSpring(springs[s].tension, springs[s].damping, springs[s].mass, t, velocities[v], 0.001, 0.06, &referenceComplete);
+
+                XNCoreTestsExpect("spring position", x, reference, 1e-4);
+
+                // Near the threshold the precision can differ; elsewhere it should agree.
+                if (fabs(x - reference) < 1e-6) {
+                    XNCoreTestsExpectTrue("spring completion", complete == referenceComplete);
+                }
+            }
+        }
+    }
+
+    bool complete = false;
+    XNCoreSpringEvaluate(&springs[0], 10.0, 0.0, 0.001, 0.06, &complete);
+    XNCoreTestsExpectTrue("spring rests", complete);
+
+    XNCoreTestsSpringInvariants();
+
+    // Nothing to move and no velocity is at rest right away.
+    double from[1] = { 5.0 };
+    double to[1] = { 5.0 };
+    double velocity[1] = { 0.0 };
+    double position[1];
+
+    XNCoreSpringEvaluateBatch(&springs[0], 1, 0.0, velocity, from, to, 0.5, 30.0, position, &complete);
+    XNCoreTestsExpect("spring empty range", position[0], 5.0, 0.0);
+    XNCoreTestsExpectTrue("spring empty range complete", complete);
+
+    // With a velocity, it overshoots in that direction and comes back.
+    velocity[0] = 200.0;
+
+    XNCoreSpringEvaluateBatch(&springs[0], 1, 1.0 / 60.0, velocity, from, to, 0.5, 30.0, position, &complete);
+    XNCoreTestsExpectTrue("spring empty range moves", position[0] > 5.5);
+    XNCoreTestsExpectTrue("spring empty range moving", !complete);
+
+    XNCoreSpringEvaluateBatch(&springs[0], 1, 10.0, velocity, from, to, 0.5, 30.0, position, &complete);
+    XNCoreTestsExpect("spring empty range returns", position[0], 5.0, 0.0);
+    XNCoreTestsExpectTrue("spring empty range returns complete", complete);
+}
+
+// Decay
+
+static float XNCoreTestsReferenceDecayDistance(float c, float t, float v0, float x0) {
+    return x0 + c * v0 * (1 - powf(c, t)) / (1 - c);
+}
+
+static float XNCoreTestsReferenceDecay(float c, float b, bool inside, float elapsed, float velocity, float restDistance, float restVelocity, bool *outComplete) {
+    float v0 = velocity / 1000.0f;
+    float t = elapsed * 1000.0f;
+
+    float tSwitch = 0;
+    float xSwitch = 0;
+
+    if (inside) {
+        tSwitch = logf(-((1 - c) / (c * fabs(v0)) - 1)) / logf(c);
+
+        if (isnan(tSwitch)) {
+            tSwitch = FLT_MAX;
+        }
+
+        xSwitch = XNCoreTestsReferenceDecayDistance(c, tSwitch, v0, 0.0);
+    }
+
+    float v = 0;
+    float x = 0;
+
+    if (t < tSwitch) {
+        v = powf(c, t) * v0;
+        x = XNCoreTestsReferenceDecayDistance(c, t, v0, 0.0);
+    } else {
+        float vSwitch = powf(c, tSwitch) * v0;
+        float tAfterSwitch = t - tSwitch;
+
+        v = powf(b * c, tAfterSwitch) * vSwitch;
+        x = powf(b, tAfterSwitch) * xSwitch + c * powf(b, tAfterSwitch) * vSwitch * (1 - powf(c, tAfterSwitch)) / (1 - c) + 1.0f * (1 - powf(b, tAfterSwitch));
+    }
+
+    if (fabs(v) * 1000.0f <= restVelocity && fabs(x - 1.0) <= restDistance) {
+        *outComplete = true;
+        return 1.0;
+    } else {
+        *outComplete = false;
+        return x;
+    }
+}
+
+static float XNCoreTestsReferenceDecayTo(float from, float velocity, float constant, float sensitivity) {
+    if (velocity == 0) {
+        return from;
+    }
+
+    float v0 = velocity / 1000.0f;
+    float t = logf(sensitivity / fabs(v0)) / logf(constant);
+
+    return XNCoreTestsReferenceDecayDistance(constant, t, v0, from);
+}
+
+static void XNCoreTestsDecay(void) {
+    const XNCoreDecay decay = { 0.998, 0.99 };
+
+    // Normalized velocities: a fling that overshoots its target by far, one
+    // that barely reaches it, and one that doesn't.
+    const double velocities[3] = { 4.0, 2.1, 0.5 };
+
+    for (int inside = 0; inside <= 1; inside++) {
+        for (int v = 0; v < 3; v++) {
+            for (int i = 0; i <= 180; i++) {
+                double t = i / 60.0;
+                bool complete, referenceComplete;
+
+                double x = XNCoreDecayEvaluate(&decay, inside, t, velocities[v], 0.001, 0.06, &complete);
+                float reference = XNCoreTestsReferenceDecay(decay.constant, decay.bounce, inside, t, velocities[v], 0.001, 0.06, &referenceComplete);
+
+                XNCoreTestsExpect("decay position", x, reference, 1e-3);
+            }
+        }
+    }
+
+    const double fromValues[3] = { 0.0, 250.0, -40.0 };
+    const double flingVelocities[4] = { 0.0, 300.0, -1200.0, 3500.0 };
+
+    for (int f = 0; f < 3; f++) {
+        for (int v = 0; v < 4; v++) {
+            double to = XNCoreDecayDistance(0.998, fromValues[f], flingVelocities[v], 0.001);
+            float reference = XNCoreTestsReferenceDecayTo(fromValues[f], flingVelocities[v], 0.998f, 0.001f);
+
+            XNCoreTestsExpect("decay distance", to, reference, fabs(reference) * 1e-4 + 1e-3);
+        }
+    }
+
+    XNCoreTestsExpectTrue("decay inside", XNCoreDecayInside(10, 50, 0, 100));
+    XNCoreTestsExpectTrue("decay inside crossing", XNCoreDecayInside(-10, 50, 0, 100));
+    XNCoreTestsExpectTrue("decay outside left", !XNCoreDecayInside(-10, -50, 0, 100));
+    XNCoreTestsExpectTrue("decay outside right", !XNCoreDecayInside(110, 150, 0, 100));
+
+    // Components without inside flags bounce right away.
+    double from[1] = { 0.0 };
+    double to[1] = { 100.0 };
+    double velocity[1] = { 0.0 };
+    double position[1];
+    bool complete;
+
+    XNCoreDecayEvaluateBatch(&decay, NULL, 1, 0.5, velocity, from, to, 0.5, 30.0, position, &complete);
+
+    bool referenceComplete;
+    float reference = XNCoreTestsReferenceDecay(decay.constant, decay.bounce, false, 0.5, 0.0, 0.005, 0.3, &referenceComplete);
+    XNCoreTestsExpect("decay batch", position[0], reference * 100.0, 1e-2);
+
+    // Flung while on the target, it leaves and bounces back.
+    from[0] = 40.0;
+    to[0] = 40.0;
+    velocity[0] = -800.0;
+
+    XNCoreDecayEvaluateBatch(&decay, NULL, 1, 0.05, velocity, from, to, 0.5, 30.0, position, &complete);
+    XNCoreTestsExpectTrue("decay empty range moves", position[0] < 39.5);
+    XNCoreTestsExpectTrue("decay empty range moving", !complete);
+
+    XNCoreDecayEvaluateBatch(&decay, NULL, 1, 5.0, velocity, from, to, 0.5, 30.0, position, &complete);
+    XNCoreTestsExpect("decay empty range returns", position[0], 40.0, 0.0);
+    XNCoreTestsExpectTrue("decay empty range returns complete", complete);
+}
+
+// Elastic
+
+static void XNCoreTestsElastic(void) {
+    XNCoreTestsExpect("elastic simple", XNCoreElasticDistance(100.0, 0.55, 480.0, true), 55.0, 1e-9);
+    XNCoreTestsExpect("elastic", XNCoreElasticDistance(100.0, 0.55, 480.0, false), (100.0f * 0.55f * 480.0f) / (100.0f * 0.55f + 480.0f), 1e-4);
+    XNCoreTestsExpect("elastic zero", XNCoreElasticDistance(0.0, 0.55, 480.0, false), 0.0, 0.0);
+    XNCoreTestsExpect("elastic not bouncing", XNCoreElasticDistance(100.0, 0.0, 480.0, false), 0.0, 0.0);
+
+    // Never more than the range, however far it's dragged.
+    XNCoreTestsExpectTrue("elastic limit", XNCoreElasticDistance(1e9, 0.55, 480.0, false) < 480.0);
+}
+
+// Components
+
+static void XNCoreTestsComponents(void) {
+    struct { double x, y, width, height; } rect = { 1.5, -2.0, 320.0, 480.0 };
+    double components[4];
+
+    XNCoreTestsExpect("components size", XNCoreComponentsSize("dddd"), sizeof(rect), 0);
+    XNCoreTestsExpectTrue("components unpack", XNCoreComponentsUnpack("dddd", &rect, components));
+    XNCoreTestsExpect("components x", components[0], 1.5, 0);
+    XNCoreTestsExpect("components y", components[1], -2.0, 0);
+    XNCoreTestsExpect("components height", components[3], 480.0, 0);
+
+    components[2] = 640.0;
+    XNCoreTestsExpectTrue("components pack", XNCoreComponentsPack("dddd", components, &rect));
+    XNCoreTestsExpect("components packed width", rect.width, 640.0, 0);
+
+    // Mixed types are packed back to back.
+    unsigned char bytes[4 + 4 + 1 + 8];
+    float f = 0.25f;
+    int32_t i = -7;
+    unsigned char c = 1;
+    uint64_t q = 1234567;
+
+    memcpy(bytes, &f, 4);
+    memcpy(bytes + 4, &i, 4);
+    memcpy(bytes + 8, &c, 1);
+    memcpy(bytes + 9, &q, 8);
+
+    double mixed[4];
+    XNCoreTestsExpect("components mixed size", XNCoreComponentsSize("fiCQ"), sizeof(bytes), 0);
+    XNCoreTestsExpectTrue("components mixed unpack", XNCoreComponentsUnpack("fiCQ", bytes, mixed));
+    XNCoreTestsExpect("components float", mixed[0], 0.25, 0);
+    XNCoreTestsExpect("components int", mixed[1], -7.0, 0);
+    XNCoreTestsExpect("components char", mixed[2], 1.0, 0);
+    XNCoreTestsExpect("components long long", mixed[3], 1234567.0, 0);
+
+    unsigned char packed[sizeof(bytes)];
+    XNCoreTestsExpectTrue("components mixed pack", XNCoreComponentsPack("fiCQ", mixed, packed));
+    XNCoreTestsExpectTrue("components round trip", memcmp(bytes, packed, sizeof(bytes)) == 0);
+
+    XNCoreTestsExpect("components unsupported size", XNCoreComponentsSize("d@"), 0, 0);
+    XNCoreTestsExpectTrue("components unsupported", !XNCoreComponentsUnpack("d*", &rect, components));
+}
+
+// Scroll
+
+static void XNCoreTestsScroll(void) {
+    XNCoreScroll scroll;
+    XNCoreScrollInit(&scroll);
+
+    scroll.boundsWidth = 320.0;
+    scroll.boundsHeight = 480.0;
+    scroll.contentWidth = 320.0;
+    scroll.contentHeight = 2000.0;
+    scroll.insetTop = 20.0;
+
+    XNCoreScrollRect bounds = XNCoreScrollBounds(&scroll);
+    XNCoreTestsExpect("scroll bounds y", bounds.y, -20.0, 0.0);
+    XNCoreTestsExpect("scroll bounds width", bounds.width, 0.0, 0.0);
+    XNCoreTestsExpect("scroll bounds height", bounds.height, 1540.0, 0.0);
+    XNCoreTestsExpectTrue("scroll bounces vertically", XNCoreScrollBouncesVertically(&scroll));
+    XNCoreTestsExpectTrue("scroll doesn't bounce horizontally", !XNCoreScrollBouncesHorizontally(&scroll));
+
+    // Content smaller than the bounds in both directions can't scroll at all.
+    XNCoreScroll small = scroll;
+    small.contentWidth = 100.0;
+    small.contentHeight = 100.0;
+    small.insetTop = 0.0;
+    bounds = XNCoreScrollBounds(&small);
+    XNCoreTestsExpect("scroll small width", bounds.width, 0.0, 0.0);
+    XNCoreTestsExpect("scroll small height", bounds.height, 0.0, 0.0);
+
+    XNCoreScrollPoint offset = { 50.0, -120.0 };
+    XNCoreScrollPoint elastic = XNCoreScrollConstrain(&scroll, offset, true);
+    XNCoreTestsExpect("scroll elastic x", elastic.x, 0.0, 0.0);
+    XNCoreTestsExpect("scroll elastic y", elastic.y, -20.0 - XNCoreElasticDistance(100.0, 0.55, 480.0, false), 1e-9);
+
+    XNCoreScrollPoint constrained = XNCoreScrollConstrain(&scroll, offset, false);
+    XNCoreTestsExpect("scroll constrained y", constrained.y, -20.0, 0.0);
+
+    XNCoreScrollPoint bounceless = XNCoreScrollConstrainBounceless(&scroll, offset);
+    XNCoreTestsExpect("scroll bounceless x", bounceless.x, 0.0, 0.0);
+    XNCoreTestsExpect("scroll bounceless y", bounceless.y, -120.0, 0.0);
+
+    // Shrinking the content brings the offset back inside.
+    scroll.contentOffset.y = 1400.0;
+    scroll.contentHeight = 1000.0;
+    XNCoreTestsExpectTrue("scroll geometry moves", XNCoreScrollGeometryChanged(&scroll));
+    XNCoreTestsExpect("scroll geometry offset", scroll.contentOffset.y, 520.0, 0.0);
+}
+
+// Trace
+
+typedef struct XNCoreTestsTraceBuffer {
+    uint8_t bytes[16384];
+    size_t length;
+} XNCoreTestsTraceBuffer;
+
+static void XNCoreTestsTraceAppend(XNCoreTestsTraceBuffer *trace, const void *bytes, size_t length) {
+    memcpy(trace->bytes + trace->length, bytes, length);
+    trace->length += length;
+}
+
+static void XNCoreTestsTraceRecord(XNCoreTestsTraceBuffer *trace, uint8_t type, double timestamp) {
+    XNCoreTestsTraceAppend(trace, &type, sizeof(type));
+    XNCoreTestsTraceAppend(trace, &timestamp, sizeof(timestamp));
+}
+
+static void XNCoreTestsTraceHeader(XNCoreTestsTraceBuffer *trace, const char *magic, uint32_t version) {
+    trace->length = 0;
+    XNCoreTestsTraceAppend(trace, magic, 4);
+    XNCoreTestsTraceAppend(trace, &version, sizeof(version));
+}
+
+static void XNCoreTestsTraceConfiguration(XNCoreTestsTraceBuffer *trace, double timestamp, uint8_t flags, float scale) {
+    float values[3] = { 0.998f, 0.55f, scale };
+
+    XNCoreTestsTraceRecord(trace, XNCoreTraceRecordTypeConfiguration, timestamp);
+    XNCoreTestsTraceAppend(trace, &flags, sizeof(flags));
+    XNCoreTestsTraceAppend(trace, values, sizeof(values));
+}
+
+static void XNCoreTestsTraceGeometry(XNCoreTestsTraceBuffer *trace, double timestamp, float contentHeight) {
+    float values[10] = { 0, 0, 320, 480, 320, contentHeight, 0, 0, 0, 0 };
+
+    XNCoreTestsTraceRecord(trace, XNCoreTraceRecordTypeGeometry, timestamp);
+    XNCoreTestsTraceAppend(trace, values, sizeof(values));
+}
+
+static void XNCoreTestsTracePan(XNCoreTestsTraceBuffer *trace, double timestamp, uint8_t state, float y) {
+    float values[2] = { 0, y };
+
+    XNCoreTestsTraceRecord(trace, XNCoreTraceRecordTypePan, timestamp);
+    XNCoreTestsTraceAppend(trace, &state, sizeof(state));
+    XNCoreTestsTraceAppend(trace, values, sizeof(values));
+}
+
+// Four seconds at 60Hz, with a drag of the finger by step points each frame
+// for the first ten frames, then a release.
+static void XNCoreTestsTraceFling(XNCoreTestsTraceBuffer *trace, float step, uint8_t flags) {
+    XNCoreTestsTraceHeader(trace, "XNTR", XNCoreTraceVersion);
+    XNCoreTestsTraceConfiguration(trace, 0.0, flags, 2.0f);
+    XNCoreTestsTraceGeometry(trace, 0.0, 2000.0f);
+
+    for (int i = 0; i <= 240; i++) {
+        double t = i / 60.0;
+
+        if (i == 1) {
+            XNCoreTestsTracePan(trace, t, XNCoreScrollPanStateBegan, 0.0f);
+        } else if (i > 1 && i <= 11) {
+            XNCoreTestsTracePan(trace, t, XNCoreScrollPanStateChanged, step * (i - 1));
+        } else if (i == 12) {
+            XNCoreTestsTracePan(trace, t, XNCoreScrollPanStateEnded, step * 11);
+        }
+
+        XNCoreTestsTraceRecord(trace, XNCoreTraceRecordTypeTick, t);
+    }
+}
+
+// Returns the number of frames, or -1 if the trace couldn't be read.
+static int XNCoreTestsTraceReplay(const XNCoreTestsTraceBuffer *trace, XNCoreScrollPoint *offsets, bool *decelerating) {
+    XNCoreScroll scroll;
+    XNCoreScrollInit(&scroll);
+
+    XNCoreTraceReplay replay;
+    XNCoreTraceReplayInit(&replay, &scroll);
+
+    XNCoreTraceReader reader;
+    XNCoreTraceRecord record;
+    XNCoreTraceStatus status = XNCoreTraceReaderInit(&reader, trace->bytes, trace->length);
+    int frames = 0;
+
+    while (status == XNCoreTraceStatusRecord) {
+        status = XNCoreTraceReaderNext(&reader, &record);
+
+        if (status == XNCoreTraceStatusRecord && XNCoreTraceReplayRecord(&replay, &record)) {
+            offsets[frames] = scroll.contentOffset;
+            decelerating[frames] = scroll.decelerating;
+            frames += 1;
+        }
+    }
+
+    return (status == XNCoreTraceStatusEnd ? frames : -1);
+}
+
+static void XNCoreTestsTrace(void) {
+    static XNCoreTestsTraceBuffer trace;
+    XNCoreTraceReader reader;
+    XNCoreTraceRecord record;
+
+    XNCoreTestsTraceHeader(&trace, "XNTX", XNCoreTraceVersion);
+    XNCoreTestsExpectTrue("trace magic", XNCoreTraceReaderInit(&reader, trace.bytes, trace.length) == XNCoreTraceStatusInvalid);
+    XNCoreTestsTraceHeader(&trace, "XNTR", XNCoreTraceVersion + 1);
+    XNCoreTestsExpectTrue("trace version", XNCoreTraceReaderInit(&reader, trace.bytes, trace.length) == XNCoreTraceStatusInvalid);
+    XNCoreTestsExpectTrue("trace truncated header", XNCoreTraceReaderInit(&reader, trace.bytes, 6) == XNCoreTraceStatusTruncated);
+
+    XNCoreTestsTraceHeader(&trace, "XNTR", XNCoreTraceVersion);
+    XNCoreTestsTracePan(&trace, 1.0, XNCoreScrollPanStateChanged, 10.0f);
+    XNCoreTestsExpectTrue("trace header", XNCoreTraceReaderInit(&reader, trace.bytes, trace.length - 1) == XNCoreTraceStatusRecord);
+    XNCoreTestsExpectTrue("trace truncated record", XNCoreTraceReaderNext(&reader, &record) == XNCoreTraceStatusTruncated);
+
+    XNCoreTraceReaderInit(&reader, trace.bytes, trace.length);
+    XNCoreTestsExpectTrue("trace record", XNCoreTraceReaderNext(&reader, &record) == XNCoreTraceStatusRecord);
+    XNCoreTestsExpect("trace record timestamp", record.timestamp, 1.0, 0.0);
+    XNCoreTestsExpect("trace record state", record.state, XNCoreScrollPanStateChanged, 0.0);
+    XNCoreTestsExpect("trace record translation", record.values[1], 10.0, 0.0);
+    XNCoreTestsExpectTrue("trace end", XNCoreTraceReaderNext(&reader, &record) == XNCoreTraceStatusEnd);
+
+    XNCoreTestsTraceRecord(&trace, 9, 2.0);
+    XNCoreTraceReaderInit(&reader, trace.bytes, trace.length);
+    XNCoreTraceReaderNext(&reader, &record);
+    XNCoreTestsExpectTrue("trace unknown record", XNCoreTraceReaderNext(&reader, &record) == XNCoreTraceStatusInvalid);
+
+    // The configuration replaces the model's own.
+    XNCoreTestsTraceHeader(&trace, "XNTR", XNCoreTraceVersion);
+    XNCoreTestsTraceConfiguration(&trace, 0.0, (XNCoreTraceFlagAlwaysBounceVertical | XNCoreTraceFlagPredictsTouches), 2.0f);
+    XNCoreTestsTraceConfiguration(&trace, 0.0, XNCoreTraceFlagBounces, 0.0f);
+    XNCoreTraceReaderInit(&reader, trace.bytes, trace.length);
+    XNCoreTestsExpectTrue("trace configuration", XNCoreTraceReaderNext(&reader, &record) == XNCoreTraceStatusRecord);
+
+    XNCoreScroll scroll;
+    XNCoreScrollInit(&scroll);
+    XNCoreTraceReplay replay;
+    XNCoreTraceReplayInit(&replay, &scroll);
+    XNCoreTraceReplayRecord(&replay, &record);
+    XNCoreTestsExpectTrue("trace configuration flags", !scroll.bounces && scroll.alwaysBounceVertical && !scroll.alwaysBounceHorizontal && scroll.predictsTouches && !scroll.elasticSimpleFormula);
+    XNCoreTestsExpect("trace configuration deceleration", scroll.decelerationRate, 0.998, 1e-7);
+    XNCoreTestsExpect("trace configuration elastic", scroll.elasticConstant, 0.55, 1e-7);
+    XNCoreTestsExpect("trace configuration rest distance", scroll.restDistance, 0.25, 0.0);
+    XNCoreTestsExpect("trace configuration rest velocity", scroll.restVelocity, 15.0, 0.0);
+    XNCoreTestsExpectTrue("trace configuration scale", XNCoreTraceReaderNext(&reader, &record) == XNCoreTraceStatusInvalid);
+
+    // Flung upwards: the content follows the finger, then keeps going.
+    static XNCoreScrollPoint offsets[2][240];
+    static bool decelerating[2][240];
+    XNCoreTestsTraceFling(&trace, -20.0f, XNCoreTraceFlagBounces);
+
+    int frames = XNCoreTestsTraceReplay(&trace, offsets[0], decelerating[0]);
+    XNCoreTestsExpect("trace frames", frames, 240, 0.0);
+    XNCoreTestsExpect("trace drag", offsets[0][5].y, 100.0, 1e-9);
+    XNCoreTestsExpectTrue("trace throw decelerating", decelerating[0][12]);
+    XNCoreTestsExpectTrue("trace throw continues", offsets[0][30].y > offsets[0][11].y + 100.0);
+    XNCoreTestsExpectTrue("trace throw stops", !decelerating[0][239] && offsets[0][239].y <= 1520.0);
+
+    // The same trace always replays the same way, even predicting touches.
+    for (int predicts = 0; predicts <= 1; predicts++) {
+        XNCoreTestsTraceFling(&trace, -20.0f, (XNCoreTraceFlagBounces | (predicts ? XNCoreTraceFlagPredictsTouches : 0)));
+        XNCoreTestsTraceReplay(&trace, offsets[0], decelerating[0]);
+        XNCoreTestsTraceReplay(&trace, offsets[1], decelerating[1]);
+        XNCoreTestsExpectTrue("trace deterministic", memcmp(offsets[0], offsets[1], sizeof(offsets[0])) == 0);
+    }
+
+    // Predicting leads the finger by the latency of a frame.
+    XNCoreTestsExpect("trace prediction", offsets[0][5].y, 100.0 + 1200.0 / 60.0, 1e-6);
+
+    // Pulled down past the top and let go: it springs back to the edge.
+    XNCoreTestsTraceFling(&trace, 5.0f, XNCoreTraceFlagBounces);
+    XNCoreTestsTraceReplay(&trace, offsets[0], decelerating[0]);
+    XNCoreTestsExpectTrue("trace overscroll", offsets[0][11].y < -20.0);
+    XNCoreTestsExpectTrue("trace bounce back", !decelerating[0][239]);
+    XNCoreTestsExpect("trace bounce back offset", offsets[0][239].y, 0.0, 0.0);
+
+    // Recorded without bouncing, it stays at the edge.
+    XNCoreTestsTraceFling(&trace, 5.0f, 0);
+    XNCoreTestsTraceReplay(&trace, offsets[0], decelerating[0]);
+    XNCoreTestsExpect("trace bounceless", offsets[0][11].y, 0.0, 0.0);
+}
+
+// Timing
+
+static void XNCoreTestsTiming(void) {
+    double velocity, distance, speed;
+
+    XNCoreTimingNormalize(100.0, 300.0, 50.0, 0.5, 30.0, &velocity, &distance, &speed);
+    XNCoreTestsExpect("normalize velocity", velocity, 0.25, 1e-12);
+    XNCoreTestsExpect("normalize distance", distance, 0.0025, 1e-12);
+    XNCoreTestsExpect("normalize speed", speed, 0.15, 1e-12);
+
+    XNCoreTimingNormalize(300.0, 100.0, 50.0, 0.5, 30.0, &velocity, &distance, &speed);
+    XNCoreTestsExpect("normalize reversed velocity", velocity, -0.25, 1e-12);
+    XNCoreTestsExpect("normalize reversed distance", distance, 0.0025, 1e-12);
+
+    // Nothing to normalize against, so the values stay absolute.
+    bool normalized = XNCoreTimingNormalize(10.0, 10.0, 50.0, 0.5, 30.0, &velocity, &distance, &speed);
+    XNCoreTestsExpectTrue("normalize empty", !normalized);
+    XNCoreTestsExpect("normalize empty velocity", velocity, 50.0, 0.0);
+    XNCoreTestsExpect("normalize empty distance", distance, 0.5, 0.0);
+    XNCoreTestsExpect("normalize empty speed", speed, 30.0, 0.0);
+
+    bool complete;
+    XNCoreTestsExpect("linear", XNCoreLinearEvaluate(0.3, &complete), 0.3, 0.0);
+    XNCoreTestsExpectTrue("linear incomplete", !complete);
+    XNCoreTestsExpect("linear end", XNCoreLinearEvaluate(1.2, &complete), 1.0, 0.0);
+    XNCoreTestsExpectTrue("linear complete", complete);
+
+    XNCoreTestsExpect("step", XNCoreStepEvaluate(0.99, &complete), 0.0, 0.0);
+    XNCoreTestsExpect("step end", XNCoreStepEvaluate(1.0, &complete), 1.0, 0.0);
+
+    double durations[2] = { 1.0, 0.5 };
+    double from[2] = { 0.0, 10.0 };
+    double to[2] = { 10.0, 20.0 };
+    double positions[2];
+
+    XNCoreLinearEvaluateBatch(2, 0.5, durations, from, to, positions, &complete);
+    XNCoreTestsExpect("linear batch first", positions[0], 5.0, 1e-12);
+    XNCoreTestsExpect("linear batch second", positions[1], 20.0, 1e-12);
+    XNCoreTestsExpectTrue("linear batch incomplete", !complete);
+}
+
+int main(void) {
+    XNCoreTestsTiming();
+    XNCoreTestsBezier();
+    XNCoreTestsSpring();
+    XNCoreTestsDecay();
+    XNCoreTestsElastic();
+    XNCoreTestsComponents();
+    XNCoreTestsScroll();
+    XNCoreTestsTrace();
+
+    if (XNCoreTestsFailures > 0) {
+        fprintf(stderr, "%d failures\n", XNCoreTestsFailures);
+        return 1;
+    }
+
+    printf("all tests passed\n");
+    return 0;
+}
@@ -0,0 +1,131 @@
+//
+//  XNTraceReplay.c
+//  Animations
+//
+//  Created by Grant Paul on 1/19/13.
+//  Copyright (c) 2013 Xuzz Productions, LLC. All rights reserved.
+//
+
+// Replays a trace from XNTraceRecorder through the scroll physics, as
+// XNTraceReplayer does, and prints one line per frame: the recorded timestamp,
+// the content offset after the frame, and the wall time spent simulating it.
+//
+//     xntrace-replay <trace>
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "XNCoreScroll.h"
+#include "XNCoreTrace.h"
+
+static double XNTraceReplayTime(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + (now.tv_nsec / 1e9);
+}
+
+static void *XNTraceReplayReadFile(const char *path, size_t *outLength) {
+    FILE *file = fopen(path, "rb");
+
+    if (file == NULL) {
+        return NULL;
+    }
+
+    size_t capacity = 65536;
+    size_t length = 0;
+    unsigned char *bytes = malloc(capacity);
+
+    while (bytes != NULL) {
+        length += fread(bytes + length, 1, capacity - length, file);
+
+        if (length < capacity) {
+            break;
+        }
+
+        capacity *= 2;
+
+        unsigned char *grown = realloc(bytes, capacity);
+
+        if (grown == NULL) {
+            free(bytes);
+        }
+
+        bytes = grown;
+    }
+
+    if (bytes != NULL && ferror(file)) {
+        free(bytes);
+        bytes = NULL;
+    }
+
+    fclose(file);
+
+    *outLength = length;
+    return bytes;
+}
+
+static const char *XNTraceReplayStatusDescription(XNCoreTraceStatus status) {
+    if (status == XNCoreTraceStatusTruncated) {
+        return "trace ended inside a record";
+    } else if (status == XNCoreTraceStatusInvalid) {
+        return "not a trace, an unsupported version, or an unknown or impossible record";
+    } else {
+        return NULL;
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <trace>\n", argv[0]);
+        return 2;
+    }
+
+    size_t length = 0;
+    void *bytes = XNTraceReplayReadFile(argv[1], &length);
+
+    if (bytes == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    // Configured by the trace.
+    XNCoreScroll scroll;
+    XNCoreScrollInit(&scroll);
+
+    XNCoreTraceReplay replay;
+    XNCoreTraceReplayInit(&replay, &scroll);
+
+    XNCoreTraceReader reader;
+    XNCoreTraceRecord record;
+    XNCoreTraceStatus status = XNCoreTraceReaderInit(&reader, bytes, length);
+
+    if (status == XNCoreTraceStatusRecord) {
+        printf("# timestamp\toffset x\toffset y\tsimulation\n");
+    }
+
+    while (status == XNCoreTraceStatusRecord) {
+        status = XNCoreTraceReaderNext(&reader, &record);
+
+        if (status == XNCoreTraceStatusRecord) {
+            double start = XNTraceReplayTime();
+            bool frame = XNCoreTraceReplayRecord(&replay, &record);
+            double duration = XNTraceReplayTime() - start;
+
+            if (frame) {
+                printf("%.6f\t%.3f\t%.3f\t%.9f\n", record.timestamp, scroll.contentOffset.x, scroll.contentOffset.y, duration);
+            }
+        }
+    }
+
+    free(bytes);
+
+    if (status != XNCoreTraceStatusEnd) {
+        fprintf(stderr, "%s: %s at %lu\n", argv[1], XNTraceReplayStatusDescription(status), (unsigned long) reader.position);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,127 @@
+//
+//  XNCoreBezier.c
+//  Animations
+//
+//  Created by Grant Paul on 1/19/13.
+//  Copyright (c) 2013 Xuzz Productions, LLC. All rights reserved.
+//
+
+#include <math.h>
+
+#include "XNCoreBezier.h"
+
+static const int kXNCoreBezierNewtonsMethodIterations = 4;
+
+static double XNCoreBezierBinomial(size_t n, size_t k) {
+    double result = 1.0;
+
+    for (size_t i = 1; i <= k; i++) {
+        result = result * (n - k + i) / i;
+    }
+
+    return result;
+}
+
+// Points here include the end points, as n + 1 x, y pairs.
+static void XNCoreBezierAtTime(const double *points, size_t n, double t, double *outX, double *outY) {
+    double x = 0;
+    double y = 0;
+
+    for (size_t i = 0; i <= n; i++) {
+        double b = XNCoreBezierBinomial(n, i) * pow(t, i) * pow(1 - t, n - i);
+        x += points[i * 2 + 0] * b;
+        y += points[i * 2 + 1] * b;
+    }
+
+    *outX = x;
+    *outY = y;
+}
+
+static double XNCoreBezierDerivativeAtTime(const double *points, size_t n, double t) {
+    double dx = 0;
+
+    for (size_t i = 0; i <= (n - 1); i++) {
+        double b = XNCoreBezierBinomial(n - 1, i) * pow(t, i) * pow(1 - t, (n - 1) - i);
+        dx += n * (points[(i + 1) * 2] - points[i * 2]) * b;
+    }
+
+    return dx;
+}
+
+double XNCoreBezierSolve(const double *points, size_t pointCount, double x) {
+    size_t n = pointCount + 1;
+    double complete[(n + 1) * 2];
+
+    complete[0] = 0.0;
+    complete[1] = 0.0;
+
+    for (size_t i = 0; i < pointCount * 2; i++) {
+        complete[i + 2] = points[i];
+    }
+
+    complete[n * 2 + 0] = 1.0;
+    complete[n * 2 + 1] = 1.0;
+
+    double resultX = 0;
+    double resultY = 0;
+    double a = x;
+
+    for (int i = 0; i < kXNCoreBezierNewtonsMethodIterations; i++) {
+        XNCoreBezierAtTime(complete, n, a, &resultX, &resultY);
+        double dx = XNCoreBezierDerivativeAtTime(complete, n, a);
+
+        if (dx == 0) {
+            break;
+        }
+
+        a = a - ((resultX - x) / dx);
+    }
+
+    return resultY;
+}
+
+void XNCoreBezierCurveInit(XNCoreBezierCurve *curve, const double *points, size_t pointCount) {
+    // The end points are fixed, and solving at them can divide by zero.
+    curve->samples[0] = 0.0;
+    curve->samples[XNCoreBezierCurveSampleCount] = 1.0;
+
+    for (size_t i = 1; i < XNCoreBezierCurveSampleCount; i++) {
+        double t = (double) i / XNCoreBezierCurveSampleCount;
+        curve->samples[i] = XNCoreBezierSolve(points, pointCount, t);
+    }
+}
+
+double XNCoreBezierCurveEvaluate(const XNCoreBezierCurve *curve, double t, bool *complete) {
+    if (t >= 1.0) {
+        *complete = true;
+        return 1.0;
+    }
+
+    *complete = false;
+
+    double position = fmax(t, 0.0) * XNCoreBezierCurveSampleCount;
+    size_t sample = (size_t) floor(position);
+
+    if (sample >= XNCoreBezierCurveSampleCount) {
+        sample = XNCoreBezierCurveSampleCount - 1;
+    }
+
+    double fraction = position - sample;
+    return curve->samples[sample] + (curve->samples[sample + 1] - curve->samples[sample]) * fraction;
+}
+
+void XNCoreBezierCurveEvaluateBatch(const XNCoreBezierCurve *curve, size_t count, double elapsed, const double *durations, const double *from, const double *to, double *positions, bool *complete) {
+    bool all = true;
+
+    for (size_t i = 0; i < count; i++) {
+        bool done = false;
+        double x = XNCoreBezierCurveEvaluate(curve, elapsed / durations[i], &done);
+
+        positions[i] = from[i] + x * (to[i] - from[i]);
+        all = (all && done);
+    }
+
+    if (complete != NULL) {
+        *complete = all;
+    }
+}
@@ -0,0 +1,41 @@
+//
+//  XNCoreBezier.h
+//  Animations
+//
+//  Created by Grant Paul on 1/19/13.
+//  Copyright (c) 2013 Xuzz Productions, LLC. All rights reserved.
+//
+
+#ifndef XN_CORE_BEZIER_H
+#define XN_CORE_BEZIER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Curves are solved once at this many evenly spaced points in time, then
+// evaluated by interpolating between the samples.
+enum { XNCoreBezierCurveSampleCount = 256 };
+
+// An easing curve from (0, 0) to (1, 1), of any degree.
+typedef struct XNCoreBezierCurve {
+    double samples[XNCoreBezierCurveSampleCount + 1];
+} XNCoreBezierCurve;
+
+// Points are the x, y pairs of the control points between the end points.
+void XNCoreBezierCurveInit(XNCoreBezierCurve *curve, const double *points, size_t pointCount);
+
+// Solves for the progress at time x, without sampling.
+double XNCoreBezierSolve(const double *points, size_t pointCount, double x);
+
+double XNCoreBezierCurveEvaluate(const XNCoreBezierCurve *curve, double t, bool *complete);
+void XNCoreBezierCurveEvaluateBatch(const XNCoreBezierCurve *curve, size_t count, double elapsed, const double *durations, const double *from, const double *to, double *positions, bool *complete);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,95 @@
+//
+//  XNCoreComponents.c
+//  Animations
+//
+//  Created by Grant Paul on 1/19/13.
+//  Copyright (c) 2013 Xuzz Productions, LLC. All rights reserved.
+//
+
+#include <stdint.h>
+#include <string.h>
+
+#include "XNCoreComponents.h"
+
+// Sizes follow the Objective-C runtime, where 'l' is always 32 bits.
+static size_t XNCoreComponentsSizeForType(char type) {
+    switch (type) {
+        case 'c': case 'C': case 'B': return 1;
+        case 's': case 'S': return 2;
+        case 'i': case 'I': case 'l': case 'L': case 'f': return 4;
+        case 'q': case 'Q': case 'd': return 8;
+        default: return 0;
+    }
+}
+
+size_t XNCoreComponentsSize(const char *types) {
+    size_t total = 0;
+
+    for (const char *type = types; *type != '\0'; type++) {
+        size_t size = XNCoreComponentsSizeForType(*type);
+
+        if (size == 0) {
+            return 0;
+        }
+
+        total += size;
+    }
+
+    return total;
+}
+
+#define XN_CORE_COMPONENTS_READ(ctype) { ctype v; memcpy(&v, field, sizeof(v)); components[i] = (double) v; }
+#define XN_CORE_COMPONENTS_WRITE(ctype) { ctype v = (ctype) components[i]; memcpy(field, &v, sizeof(v)); }
+
+bool XNCoreComponentsUnpack(const char *types, const void *bytes, double *components) {
+    const unsigned char *field = bytes;
+
+    for (size_t i = 0; types[i] != '\0'; i++) {
+        switch (types[i]) {
+            case 'f': XN_CORE_COMPONENTS_READ(float); break;
+            case 'd': XN_CORE_COMPONENTS_READ(double); break;
+            case 'c': XN_CORE_COMPONENTS_READ(int8_t); break;
+            case 'C': XN_CORE_COMPONENTS_READ(uint8_t); break;
+            case 'B': XN_CORE_COMPONENTS_READ(_Bool); break;
+            case 's': XN_CORE_COMPONENTS_READ(int16_t); break;
+            case 'S': XN_CORE_COMPONENTS_READ(uint16_t); break;
+            case 'i': case 'l': XN_CORE_COMPONENTS_READ(int32_t); break;
+            case 'I': case 'L': XN_CORE_COMPONENTS_READ(uint32_t); break;
+            case 'q': XN_CORE_COMPONENTS_READ(int64_t); break;
+            case 'Q': XN_CORE_COMPONENTS_READ(uint64_t); break;
+            default: return false;
+        }
+
+        field += XNCoreComponentsSizeForType(types[i]);
+    }
+
+    return true;
+}
+
+bool XNCoreComponentsPack(const char *types, const double *components, void *bytes) {
+    unsigned char *field = bytes;
+
+    for (size_t i = 0; types[i] != '\0'; i++) {
+        switch (types[i]) {
+            case 'f': XN_CORE_COMPONENTS_WRITE(float); break;
+            case 'd': XN_CORE_COMPONENTS_WRITE(double); break;
+            case 'c': XN_CORE_COMPONENTS_WRITE(int8_t); break;
+            case 'C': XN_CORE_COMPONENTS_WRITE(uint8_t); break;
+            case 'B': XN_CORE_COMPONENTS_WRITE(_Bool); break;
+            case 's': XN_CORE_COMPONENTS_WRITE(int16_t); break;
+            case 'S': XN_CORE_COMPONENTS_WRITE(uint16_t); break;
+            case 'i': case 'l': XN_CORE_COMPONENTS_WRITE(int32_t); break;
+            case 'I': case 'L': XN_CORE_COMPONENTS_WRITE(uint32_t); break;
+            case 'q': XN_CORE_COMPONENTS_WRITE(int64_t); break;
+            case 'Q': XN_CORE_COMPONENTS_WRITE(uint64_t); break;
+            default: return false;
+        }
+
+        field += XNCoreComponentsSizeForType(types[i]);
+    }
+
+    return true;
+}
+
+#undef XN_CORE_COMPONENTS_READ
+#undef XN_CORE_COMPONENTS_WRITE
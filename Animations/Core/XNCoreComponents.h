@@ -0,0 +1,34 @@
+//
+//  XNCoreComponents.h
+//  Animations
+//
+//  Created by Grant Paul on 1/19/13.
+//  Copyright (c) 2013 Xuzz Productions, LLC. All rights reserved.
+//
+
+#ifndef XN_CORE_COMPONENTS_H
+#define XN_CORE_COMPONENTS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Packing of structures to and from their scalar components. Types are the
+// flattened Objective-C type encodings of the fields, one character each and
+// packed without padding ("dddd" for a CGRect on 64-bit).
+
+// The size in bytes of the packed fields, or 0 if a type isn't supported.
+size_t XNCoreComponentsSize(const char *types);
+
+// Returns false if a type isn't supported. Components has one entry per type.
+bool XNCoreComponentsUnpack(const char *types, const void *bytes, double *components);
+bool XNCoreComponentsPack(const char *types, const double *components, void *bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,163 @@
+//
+//  XNCoreDecay.c
+//  Animations
+//
+//  Created by Grant Paul on 1/19/13.
+//  Copyright (c) 2013 Xuzz Productions, LLC. All rights reserved.
+//
+
+#include <float.h>
+#include <math.h>
+
+#include "XNCoreDecay.h"
+#include "XNCoreTiming.h"
+
+static const double kXNCoreDecayTemporalSensitivity = 1000.0;
+
+// The basic scroll view algorithm, each frame:
+//
+// v = v * c                 -- constant friciton
+// x = x + v                 -- v = dx/dt
+// if outside:
+//   x = x - d * (1 - b)     -- the magic: move back
+//   v = v * b               -- slow down faster
+//
+// d: distance outside scroll view
+// c: scrolling constant; 0.998
+// b: bounce constant; 0.99
+//
+// Apple implements this strangely. Rather than taking an integral of the above,
+// they use a summation over every millisecond. To reproduce the same behavior
+// and to allow for use of identical scrolling and bounce coefficients, the same
+// strange features are emulated here, with the millisecond conversion factor
+// stored in kXNCoreDecayTemporalSensitivity and the simplification of the
+// summation present in the following functions.
+
+static double XNCoreDecaySimpleVelocityAtTime(double c, double t, double v0) {
+    return pow(c, t) * v0;
+}
+
+static double XNCoreDecaySimpleDistanceAtTime(double c, double t, double v0, double x0) {
+    return x0 + c * v0 * (1 - pow(c, t)) / (1 - c);
+}
+
+static double XNCoreDecayBouncingVelocityAtTime(double c, double b, double t, double v0) {
+    return pow(b * c, t) * v0;
+}
+
+static double XNCoreDecayBouncingDistanceAtTime(double c, double b, double t, double v0, double x0, double xF) {
+    return pow(b, t) * x0 + c * pow(b, t) * v0 * (1 - pow(c, t)) / (1 - c) + xF * (1 - pow(b, t));
+}
+
+double XNCoreDecayDistance(double constant, double from, double velocity, double sensitivity) {
+    if (velocity == 0) {
+        return from;
+    }
+
+    double v0 = velocity / kXNCoreDecayTemporalSensitivity;
+
+    // Solve for time when velocity = sensitivity.
+    double t = log(sensitivity / fabs(v0)) / log(constant);
+    return XNCoreDecaySimpleDistanceAtTime(constant, t, v0, from);
+}
+
+bool XNCoreDecayInside(double from, double to, double minimum, double maximum) {
+    bool leftOutside = (from <= minimum && to <= minimum);
+    bool rightOutside = (from >= maximum && to >= maximum);
+
+    return (!rightOutside && !leftOutside);
+}
+
+// Solves for the distance travelled, with the velocity per millisecond. The
+// decay bounces back to the target distance once it's reached or passed.
+static double XNCoreDecaySolve(const XNCoreDecay *decay, bool inside, double elapsed, double velocity, double target, double *outVelocity) {
+    double c = decay->constant;
+    double b = decay->bounce;
+
+    double v0 = velocity / kXNCoreDecayTemporalSensitivity;
+    double t = elapsed * kXNCoreDecayTemporalSensitivity;
+
+    double tSwitch = 0;
+    double xSwitch = 0;
+
+    if (inside) {
+        // Solve for time when distance equals the target d.
+        // c * v0 * (1 - c^t) / (1 - c) = d
+        // d / (c * v0) = (1 - c^t) / (1 - c)
+        // d * (1 - c) / (c * v0) = 1 - c^t
+        // 1 - d * (1 - c) / (c * v0) = c^t
+        // t = log(1 - d * (1 - c) / (c * |v0|)) / log(c)
+        tSwitch = log(1 - target * (1 - c) / (c * fabs(v0))) / log(c);
+
+        if (isnan(tSwitch)) {
+            // Never gets there, so never bounces.
+            tSwitch = DBL_MAX;
+        }
+
+        xSwitch = XNCoreDecaySimpleDistanceAtTime(c, tSwitch, v0, 0.0);
+    }
+
+    double v = 0;
+    double x = 0;
+
+    if (t < tSwitch) {
+        v = XNCoreDecaySimpleVelocityAtTime(c, t, v0);
+        x = XNCoreDecaySimpleDistanceAtTime(c, t, v0, 0.0);
+    } else {
+        double vSwitch = XNCoreDecaySimpleVelocityAtTime(c, tSwitch, v0);
+        double tAfterSwitch = t - tSwitch;
+
+        v = XNCoreDecayBouncingVelocityAtTime(c, b, tAfterSwitch, vSwitch);
+        x = XNCoreDecayBouncingDistanceAtTime(c, b, tAfterSwitch, vSwitch, xSwitch, target);
+    }
+
+    *outVelocity = v;
+    return x;
+}
+
+// Velocity here is per millisecond; the rest velocity is per second.
+static bool XNCoreDecayResting(double x, double v, double target, double restDistance, double restVelocity) {
+    return (fabs(v) * kXNCoreDecayTemporalSensitivity <= restVelocity && fabs(x - target) <= restDistance);
+}
+
+double XNCoreDecayEvaluate(const XNCoreDecay *decay, bool inside, double elapsed, double velocity, double restDistance, double restVelocity, bool *complete) {
+    double v = 0;
+    double x = XNCoreDecaySolve(decay, inside, elapsed, velocity, 1.0, &v);
+
+    if (XNCoreDecayResting(x, v, 1.0, restDistance, restVelocity)) {
+        *complete = true;
+        return 1.0;
+    } else {
+        *complete = false;
+        return x;
+    }
+}
+
+void XNCoreDecayEvaluateBatch(const XNCoreDecay *decay, const bool *inside, size_t count, double elapsed, const double *velocities, const double *from, const double *to, double restDistance, double restVelocity, double *positions, bool *complete) {
+    bool all = true;
+
+    for (size_t i = 0; i < count; i++) {
+        double velocity, distance, speed;
+        bool between = (inside != NULL && inside[i]);
+        bool done = false;
+
+        if (XNCoreTimingNormalize(from[i], to[i], velocities[i], restDistance, restVelocity, &velocity, &distance, &speed)) {
+            double x = XNCoreDecayEvaluate(decay, between, elapsed, velocity, distance, speed, &done);
+            positions[i] = from[i] + x * (to[i] - from[i]);
+        } else {
+            // Already on the target, so bounce straight back to it, in the
+            // units of the components.
+            double v = 0;
+            double x = XNCoreDecaySolve(decay, between, elapsed, velocity, 0.0, &v);
+
+            done = XNCoreDecayResting(x, v, 0.0, distance, speed);
+            positions[i] = (done ? to[i] : from[i] + x);
+        }
+
+        all = (all && done);
+    }
+
+    if (complete != NULL) {
+        *complete = all;
+    }
+}
@@ -0,0 +1,43 @@
+//
+//  XNCoreDecay.h
+//  Animations
+//
+//  Created by Grant Paul on 1/19/13.
+//  Copyright (c) 2013 Xuzz Productions, LLC. All rights reserved.
+//
+
+#ifndef XN_CORE_DECAY_H
+#define XN_CORE_DECAY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Scroll view deceleration: friction until the target is reached, then a
+// bounce back to it. See XNCoreDecay.c for the derivation.
+typedef struct XNCoreDecay {
+    double constant;
+    double bounce;
+} XNCoreDecay;
+
+// Where a value moving at a velocity (per second) comes to rest, without
+// bouncing, once its speed (per millisecond) drops below the sensitivity.
+double XNCoreDecayDistance(double constant, double from, double velocity, double sensitivity);
+
+// Whether a decay from one value to another starts between the bounds, and so
+// should decelerate before bouncing rather than bounce right away.
+bool XNCoreDecayInside(double from, double to, double minimum, double maximum);
+
+double XNCoreDecayEvaluate(const XNCoreDecay *decay, bool inside, double elapsed, double velocity, double restDistance, double restVelocity, bool *complete);
+
+// Inside can be NULL if no components are inside.
+void XNCoreDecayEvaluateBatch(const XNCoreDecay *decay, const bool *inside, size_t count, double elapsed, const double *velocities, const double *from, const double *to, double restDistance, double restVelocity, double *positions, bool *complete);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,17 @@
+//
+//  XNCoreElastic.c
+//  Animations
+//
+//  Created by Grant Paul on 1/19/13.
+//  Copyright (c) 2013 Xuzz Productions, LLC. All rights reserved.
+//
+
+#include "XNCoreElastic.h"
+
+double XNCoreElasticDistance(double distance, double constant, double range, bool simple) {
+    if (simple) {
+        return distance * constant;
+    } else {
+        return (distance * constant * range) / (distance * constant + range);
+    }
+}
@@ -0,0 +1,26 @@
+//
+//  XNCoreElastic.h
+//  Animations
+//
+//  Created by Grant Paul on 1/19/13.
+//  Copyright (c) 2013 Xuzz Productions, LLC. All rights reserved.
+//
+
+#ifndef XN_CORE_ELASTIC_H
+#define XN_CORE_ELASTIC_H
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// How far content dragged a distance past its edge actually moves. The simple
+// formula scales by the constant; the other, like iOS 6, approaches the range.
+double XNCoreElasticDistance(double distance, double constant, double range, bool simple);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
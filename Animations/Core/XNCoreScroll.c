@@ -0,0 +1,321 @@
+//
+//  XNCoreScroll.c
+//  Animations
+//
+//  Created by Grant Paul on 1/19/13.
+//  Copyright (c) 2013 Xuzz Productions, LLC. All rights reserved.
+//
+
+#include <math.h>
+#include <string.h>
+
+#include "XNCoreScroll.h"
+#include "XNCoreDecay.h"
+#include "XNCoreElastic.h"
+
+static const double kXNCoreScrollDefaultElasticConstant = 0.55;
+static const double kXNCoreScrollDefaultDecelerationRate = 0.998;
+static const double kXNCoreScrollDefaultDecelerationBounce = 0.99;
+static const double kXNCoreScrollDefaultRestDistance = 0.5;
+static const double kXNCoreScrollDefaultRestVelocity = 0.5 * 60.0;
+
+// Released slower than this (and inside the bounds), the content just stops.
+static const double kXNCoreScrollDecelerationMinimumVelocity = 250.0;
+
+// Where deceleration aims for, as in XNDecayTimingFunction's default.
+static const double kXNCoreScrollDecelerationSensitivity = 0.001;
+
+// The release velocity is the slope of a least-squares fit through the touch
+// samples from the end of the drag. When predicting, the content is moved to
+// where the finger is expected to be once the frame is on screen.
+static const double kXNCoreScrollTouchSampleWindow = 0.1;
+static const double kXNCoreScrollTouchPredictionLatency = (1.0 / 60.0);
+static const double kXNCoreScrollTouchPredictionMaximumInterval = 0.05;
+
+void XNCoreScrollInit(XNCoreScroll *scroll) {
+    memset(scroll, 0, sizeof(*scroll));
+
+    scroll->bounces = true;
+    scroll->elasticConstant = kXNCoreScrollDefaultElasticConstant;
+
+    scroll->decelerationRate = kXNCoreScrollDefaultDecelerationRate;
+    scroll->decelerationBounce = kXNCoreScrollDefaultDecelerationBounce;
+    scroll->restDistance = kXNCoreScrollDefaultRestDistance;
+    scroll->restVelocity = kXNCoreScrollDefaultRestVelocity;
+}
+
+void XNCoreScrollSetScreenScale(XNCoreScroll *scroll, double scale) {
+    scroll->restDistance = kXNCoreScrollDefaultRestDistance / scale;
+    scroll->restVelocity = kXNCoreScrollDefaultRestVelocity / scale;
+}
+
+XNCoreScrollRect XNCoreScrollBounds(const XNCoreScroll *scroll) {
+    double contentWidth = fmax(scroll->contentWidth, scroll->boundsWidth);
+    double contentHeight = fmax(scroll->contentHeight, scroll->boundsHeight);
+
+    // Insets extend the range past the content.
+    XNCoreScrollRect bounds;
+    bounds.x = -scroll->insetLeft;
+    bounds.y = -scroll->insetTop;
+    bounds.width = (contentWidth - scroll->boundsWidth) + scroll->insetLeft + scroll->insetRight;
+    bounds.height = (contentHeight - scroll->boundsHeight) + scroll->insetTop + scroll->insetBottom;
+
+    return bounds;
+}
+
+// As CGRectContainsPoint(): the maximum edges are outside.
+static bool XNCoreScrollRectContainsPoint(XNCoreScrollRect rect, XNCoreScrollPoint point) {
+    double minX = fmin(rect.x, rect.x + rect.width);
+    double maxX = fmax(rect.x, rect.x + rect.width);
+    double minY = fmin(rect.y, rect.y + rect.height);
+    double maxY = fmax(rect.y, rect.y + rect.height);
+
+    return (point.x >= minX && point.x < maxX && point.y >= minY && point.y < maxY);
+}
+
+bool XNCoreScrollBouncesHorizontally(const XNCoreScroll *scroll) {
+    XNCoreScrollRect bounds = XNCoreScrollBounds(scroll);
+    return scroll->bounces && (scroll->alwaysBounceHorizontal || bounds.width > 0);
+}
+
+bool XNCoreScrollBouncesVertically(const XNCoreScroll *scroll) {
+    XNCoreScrollRect bounds = XNCoreScrollBounds(scroll);
+    return scroll->bounces && (scroll->alwaysBounceVertical || bounds.height > 0);
+}
+
+static double XNCoreScrollConstrainPosition(double position, double edge, double length, double constant, double range, bool simple) {
+    double minimum = fmin(edge, edge + length);
+    double maximum = fmax(edge, edge + length);
+
+    if (position < minimum) {
+        return minimum - XNCoreElasticDistance(minimum - position, constant, range, simple);
+    } else if (position > maximum) {
+        return maximum + XNCoreElasticDistance(position - maximum, constant, range, simple);
+    } else {
+        return position;
+    }
+}
+
+XNCoreScrollPoint XNCoreScrollConstrain(const XNCoreScroll *scroll, XNCoreScrollPoint offset, bool elastic) {
+    XNCoreScrollRect bounds = XNCoreScrollBounds(scroll);
+
+    double constant = (elastic ? scroll->elasticConstant : 0.0);
+    double horizontalConstant = (XNCoreScrollBouncesHorizontally(scroll) ? constant : 0.0);
+    double verticalConstant = (XNCoreScrollBouncesVertically(scroll) ? constant : 0.0);
+
+    offset.x = XNCoreScrollConstrainPosition(offset.x, bounds.x, bounds.width, horizontalConstant, scroll->boundsWidth, scroll->elasticSimpleFormula);
+    offset.y = XNCoreScrollConstrainPosition(offset.y, bounds.y, bounds.height, verticalConstant, scroll->boundsHeight, scroll->elasticSimpleFormula);
+
+    return offset;
+}
+
+XNCoreScrollPoint XNCoreScrollConstrainBounceless(const XNCoreScroll *scroll, XNCoreScrollPoint offset) {
+    bool horizontal = XNCoreScrollBouncesHorizontally(scroll);
+    bool vertical = XNCoreScrollBouncesVertically(scroll);
+
+    if (!horizontal || !vertical) {
+        XNCoreScrollPoint constrained = XNCoreScrollConstrain(scroll, offset, false);
+
+        if (!horizontal) {
+            offset.x = constrained.x;
+        }
+
+        if (!vertical) {
+            offset.y = constrained.y;
+        }
+    }
+
+    return offset;
+}
+
+static void XNCoreScrollTouchSamplesReset(XNCoreScroll *scroll) {
+    scroll->touchSampleStart = 0;
+    scroll->touchSampleCount = 0;
+}
+
+static void XNCoreScrollTouchSamplesAdd(XNCoreScroll *scroll, double timestamp, XNCoreScrollPoint position) {
+    size_t index = (scroll->touchSampleStart + scroll->touchSampleCount) % XNCoreScrollTouchSampleCount;
+
+    if (scroll->touchSampleCount == XNCoreScrollTouchSampleCount) {
+        scroll->touchSampleStart = (scroll->touchSampleStart + 1) % XNCoreScrollTouchSampleCount;
+    } else {
+        scroll->touchSampleCount += 1;
+    }
+
+    scroll->touchSamples[index].timestamp = timestamp;
+    scroll->touchSamples[index].position = position;
+}
+
+// Returns false if there aren't enough recent samples to fit a line through.
+static bool XNCoreScrollTouchSamplesVelocity(const XNCoreScroll *scroll, XNCoreScrollPoint *outVelocity) {
+    if (scroll->touchSampleCount == 0) {
+        return false;
+    }
+
+    size_t last = (scroll->touchSampleStart + scroll->touchSampleCount - 1) % XNCoreScrollTouchSampleCount;
+    double now = scroll->touchSamples[last].timestamp;
+
+    // Times are relative to the latest sample to keep the sums small.
+    double n = 0, st = 0, stt = 0, sx = 0, sy = 0, stx = 0, sty = 0;
+
+    for (size_t i = 0; i < scroll->touchSampleCount; i++) {
+        const XNCoreScrollTouchSample *sample = &scroll->touchSamples[(scroll->touchSampleStart + i) % XNCoreScrollTouchSampleCount];
+        double t = sample->timestamp - now;
+
+        if (-t > kXNCoreScrollTouchSampleWindow) {
+            continue;
+        }
+
+        n += 1;
+        st += t;
+        stt += t * t;
+        sx += sample->position.x;
+        sy += sample->position.y;
+        stx += t * sample->position.x;
+        sty += t * sample->position.y;
+    }
+
+    double denominator = n * stt - st * st;
+
+    if (n < 2 || denominator <= 0) {
+        return false;
+    }
+
+    outVelocity->x = (n * stx - st * sx) / denominator;
+    outVelocity->y = (n * sty - st * sy) / denominator;
+
+    return true;
+}
+
+// Aims for where friction alone would stop, kept within the bounds; the decay
+// bounces back from the edge if it gets there first.
+static void XNCoreScrollUpdateThrow(XNCoreScroll *scroll) {
+    XNCoreScrollRect bounds = XNCoreScrollBounds(scroll);
+
+    XNCoreScrollPoint to;
+    to.x = XNCoreDecayDistance(scroll->decelerationRate, scroll->throwFrom.x, scroll->throwVelocity.x, kXNCoreScrollDecelerationSensitivity);
+    to.y = XNCoreDecayDistance(scroll->decelerationRate, scroll->throwFrom.y, scroll->throwVelocity.y, kXNCoreScrollDecelerationSensitivity);
+    to = XNCoreScrollConstrain(scroll, to, false);
+
+    scroll->throwTo = to;
+    scroll->throwInside[0] = XNCoreDecayInside(scroll->throwFrom.x, to.x, fmin(bounds.x, bounds.x + bounds.width), fmax(bounds.x, bounds.x + bounds.width));
+    scroll->throwInside[1] = XNCoreDecayInside(scroll->throwFrom.y, to.y, fmin(bounds.y, bounds.y + bounds.height), fmax(bounds.y, bounds.y + bounds.height));
+}
+
+bool XNCoreScrollStep(XNCoreScroll *scroll, double dt) {
+    if (!scroll->decelerating) {
+        return false;
+    }
+
+    scroll->throwElapsed += dt;
+
+    XNCoreDecay decay = { scroll->decelerationRate, scroll->decelerationBounce };
+    double velocities[2] = { scroll->throwVelocity.x, scroll->throwVelocity.y };
+    double from[2] = { scroll->throwFrom.x, scroll->throwFrom.y };
+    double to[2] = { scroll->throwTo.x, scroll->throwTo.y };
+    double positions[2];
+
+    bool complete = false;
+    XNCoreDecayEvaluateBatch(&decay, scroll->throwInside, 2, scroll->throwElapsed, velocities, from, to, scroll->restDistance, scroll->restVelocity, positions, &complete);
+
+    XNCoreScrollPoint offset = { positions[0], positions[1] };
+    scroll->contentOffset = XNCoreScrollConstrainBounceless(scroll, offset);
+
+    if (complete) {
+        scroll->decelerating = false;
+        scroll->scrolling = false;
+    }
+
+    return scroll->decelerating;
+}
+
+void XNCoreScrollStop(XNCoreScroll *scroll) {
+    scroll->decelerating = false;
+    scroll->scrolling = false;
+}
+
+bool XNCoreScrollGeometryChanged(XNCoreScroll *scroll) {
+    if (scroll->decelerating) {
+        XNCoreScrollUpdateThrow(scroll);
+    }
+
+    if (!scroll->dragging) {
+        XNCoreScrollRect bounds = XNCoreScrollBounds(scroll);
+        XNCoreScrollPoint offset = scroll->contentOffset;
+
+        if (!XNCoreScrollRectContainsPoint(bounds, offset)) {
+            scroll->contentOffset = XNCoreScrollConstrain(scroll, offset, false);
+            return (scroll->contentOffset.x != offset.x || scroll->contentOffset.y != offset.y);
+        }
+    }
+
+    return false;
+}
+
+XNCoreScrollPanResult XNCoreScrollPan(XNCoreScroll *scroll, XNCoreScrollPanState state, XNCoreScrollPoint translation, double timestamp, double now) {
+    if (state == XNCoreScrollPanStateBegan) {
+        scroll->decelerating = false;
+        scroll->dragging = true;
+        scroll->scrolling = true;
+
+        scroll->panStartContentOffset = scroll->contentOffset;
+
+        XNCoreScrollTouchSamplesReset(scroll);
+        XNCoreScrollTouchSamplesAdd(scroll, timestamp, scroll->panStartContentOffset);
+
+        return XNCoreScrollPanResultBegan;
+    } else if (state == XNCoreScrollPanStateCancelled) {
+        scroll->dragging = false;
+        scroll->scrolling = false;
+
+        return XNCoreScrollPanResultCancelled;
+    } else if (state != XNCoreScrollPanStateChanged && state != XNCoreScrollPanStateEnded) {
+        return XNCoreScrollPanResultNone;
+    }
+
+    XNCoreScrollPoint position;
+    position.x = scroll->panStartContentOffset.x - translation.x;
+    position.y = scroll->panStartContentOffset.y - translation.y;
+
+    XNCoreScrollTouchSamplesAdd(scroll, timestamp, position);
+
+    // No recent samples to fit means the finger has been still.
+    XNCoreScrollPoint velocity = { 0, 0 };
+    bool velocityValid = XNCoreScrollTouchSamplesVelocity(scroll, &velocity);
+
+    // Predict for the end of the drag too, so the throw doesn't start behind
+    // where the content was last shown.
+    if (scroll->predictsTouches && velocityValid) {
+        double interval = (now - timestamp) + kXNCoreScrollTouchPredictionLatency;
+        interval = fmin(interval, kXNCoreScrollTouchPredictionMaximumInterval);
+
+        position.x += velocity.x * interval;
+        position.y += velocity.y * interval;
+    }
+
+    position = XNCoreScrollConstrain(scroll, position, true);
+
+    if (state == XNCoreScrollPanStateChanged) {
+        scroll->contentOffset = position;
+        return XNCoreScrollPanResultMoved;
+    }
+
+    double speed = sqrt(velocity.x * velocity.x + velocity.y * velocity.y);
+    bool stopped = (speed <= kXNCoreScrollDecelerationMinimumVelocity);
+    bool inside = XNCoreScrollRectContainsPoint(XNCoreScrollBounds(scroll), position);
+
+    scroll->dragging = false;
+
+    if (!stopped || !inside) {
+        scroll->throwFrom = position;
+        scroll->throwVelocity = velocity;
+        scroll->throwElapsed = 0;
+        XNCoreScrollUpdateThrow(scroll);
+
+        scroll->decelerating = true;
+        return XNCoreScrollPanResultDecelerating;
+    } else {
+        scroll->scrolling = false;
+        return XNCoreScrollPanResultStopped;
+    }
+}
@@ -0,0 +1,148 @@
+//
+//  XNCoreScroll.h
+//  Animations
+//
+//  Created by Grant Paul on 1/19/13.
+//  Copyright (c) 2013 Xuzz Productions, LLC. All rights reserved.
+//
+
+#ifndef XN_CORE_SCROLL_H
+#define XN_CORE_SCROLL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The physics behind XNScrollView: dragging against elastic edges, the release
+// velocity, and decelerating with a bounce. Nothing here reads a clock; times
+// are passed in, so the same input always scrolls the same way, and a trace
+// can be replayed without a scroll view (see XNCoreTrace.h).
+
+typedef struct XNCoreScrollPoint {
+    double x;
+    double y;
+} XNCoreScrollPoint;
+
+typedef struct XNCoreScrollRect {
+    double x;
+    double y;
+    double width;
+    double height;
+} XNCoreScrollRect;
+
+// The same values as UIGestureRecognizerState.
+enum {
+    XNCoreScrollPanStateBegan = 1,
+    XNCoreScrollPanStateChanged = 2,
+    XNCoreScrollPanStateEnded = 3,
+    XNCoreScrollPanStateCancelled = 4
+};
+
+typedef int XNCoreScrollPanState;
+
+// What a pan did, so the owner knows what to tell its delegate.
+enum {
+    XNCoreScrollPanResultNone,
+    XNCoreScrollPanResultBegan,
+    XNCoreScrollPanResultMoved, // the content offset changed
+    XNCoreScrollPanResultDecelerating, // released, and now decelerating
+    XNCoreScrollPanResultStopped, // released in place
+    XNCoreScrollPanResultCancelled
+};
+
+typedef int XNCoreScrollPanResult;
+
+enum { XNCoreScrollTouchSampleCount = 16 };
+
+typedef struct XNCoreScrollTouchSample {
+    double timestamp;
+    XNCoreScrollPoint position;
+} XNCoreScrollTouchSample;
+
+typedef struct XNCoreScroll {
+    // Configuration, kept up to date by the owner.
+    double boundsWidth;
+    double boundsHeight;
+    double contentWidth;
+    double contentHeight;
+    double insetTop;
+    double insetLeft;
+    double insetBottom;
+    double insetRight;
+
+    bool bounces;
+    bool alwaysBounceHorizontal;
+    bool alwaysBounceVertical;
+    bool elasticSimpleFormula; // see XNCoreElasticDistance()
+    double elasticConstant;
+
+    bool predictsTouches;
+
+    double decelerationRate; // decay constant, see XNCoreDecay
+    double decelerationBounce;
+    double restDistance; // in points
+    double restVelocity; // in points per second
+
+    // State.
+    XNCoreScrollPoint contentOffset;
+    bool dragging;
+    bool decelerating;
+    bool scrolling;
+
+    XNCoreScrollPoint panStartContentOffset;
+    XNCoreScrollTouchSample touchSamples[XNCoreScrollTouchSampleCount];
+    size_t touchSampleStart;
+    size_t touchSampleCount;
+
+    // Deceleration, which starts where the finger was released.
+    XNCoreScrollPoint throwFrom;
+    XNCoreScrollPoint throwTo;
+    XNCoreScrollPoint throwVelocity;
+    bool throwInside[2];
+    double throwElapsed;
+} XNCoreScroll;
+
+// Sets up an empty scroll view that bounces, with the normal deceleration
+// rate and rest thresholds of half a point.
+void XNCoreScrollInit(XNCoreScroll *scroll);
+
+// Sets the rest thresholds to half a pixel, and that per frame at 60Hz, for
+// a screen with this many pixels per point.
+void XNCoreScrollSetScreenScale(XNCoreScroll *scroll, double scale);
+
+// The range of content offsets that doesn't show past the edges.
+XNCoreScrollRect XNCoreScrollBounds(const XNCoreScroll *scroll);
+bool XNCoreScrollBouncesHorizontally(const XNCoreScroll *scroll);
+bool XNCoreScrollBouncesVertically(const XNCoreScroll *scroll);
+
+// Brings an offset back within the bounds. Elastic only goes partway, as if
+// the content were pulled past the edge; axes that don't bounce always go back
+// all the way.
+XNCoreScrollPoint XNCoreScrollConstrain(const XNCoreScroll *scroll, XNCoreScrollPoint offset, bool elastic);
+
+// Brings back only the axes that don't bounce, for offsets from deceleration.
+XNCoreScrollPoint XNCoreScrollConstrainBounceless(const XNCoreScroll *scroll, XNCoreScrollPoint offset);
+
+// Moves the content for the finger being at translation since the pan began.
+// Now is the current time on the same clock as the timestamp, which predicting
+// touches measures the latency of the event from.
+XNCoreScrollPanResult XNCoreScrollPan(XNCoreScroll *scroll, XNCoreScrollPanState state, XNCoreScrollPoint translation, double timestamp, double now);
+
+// Call after changing the size, content or insets. Returns true if the content
+// offset had to move back within the bounds.
+bool XNCoreScrollGeometryChanged(XNCoreScroll *scroll);
+
+// Advances deceleration. Returns false once it has stopped.
+bool XNCoreScrollStep(XNCoreScroll *scroll, double dt);
+
+// Stops decelerating, leaving the content where it is.
+void XNCoreScrollStop(XNCoreScroll *scroll);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,109 @@
+//
+//  XNCoreSpring.c
+//  Animations
+//
+//  Created by Grant Paul on 1/19/13.
+//  Copyright (c) 2013 Xuzz Productions, LLC. All rights reserved.
+//
+
+#include <math.h>
+
+#include "XNCoreSpring.h"
+#include "XNCoreTiming.h"
+
+// Damping ratios this close to one are solved as critically damped. The ratio
+// comes out of a square root, so a spring meant to be critical is rarely one
+// exactly, and the other solutions divide by nearly zero next to it.
+static const double kXNCoreSpringCriticalTolerance = 1e-6;
+
+// Solves for the displacement from the target, starting at x0 and moving at
+// v0. Positions are the target minus the displacement.
+static void XNCoreSpringSolve(const XNCoreSpring *spring, double x0, double v0, double t, double *outX, double *outDX) {
+    double k = spring->tension;
+    double b = spring->damping;
+    double m = spring->mass;
+
+    double w0 = sqrt(k / m);
+
+    double zeta = b / (2 * sqrt(m * k));
+    double x = 0;
+    double dx = 0;
+
+    if (fabs(zeta - 1.0) < kXNCoreSpringCriticalTolerance) {
+        double A = x0;
+        double B = v0 + w0 * x0;
+
+        x = exp(-w0 * t) * (A + B * t);
+        dx = exp(-w0 * t) * (B - w0 * (A + B * t));
+    } else if (zeta < 1.0) {
+        double wD = w0 * sqrt(1 - zeta * zeta);
+
+        double A = x0;
+        double B = (zeta * w0 * x0 + v0) / wD;
+
+        double envelope = exp(-zeta * w0 * t);
+        x = envelope * (A * cos(wD * t) + B * sin(wD * t));
+        dx = envelope * ((B * wD - zeta * w0 * A) * cos(wD * t) - (A * wD + zeta * w0 * B) * sin(wD * t));
+    } else {
+        // The roots of m * g^2 + b * g + k = 0.
+        double gP = -zeta * w0 + w0 * sqrt(zeta * zeta - 1);
+        double gM = -zeta * w0 - w0 * sqrt(zeta * zeta - 1);
+
+        // Chosen so x(0) = x0 and dx(0) = v0.
+        double A = (v0 - gP * x0) / (gM - gP);
+        double B = x0 - A;
+
+        x = A * exp(gM * t) + B * exp(gP * t);
+        dx = A * gM * exp(gM * t) + B * gP * exp(gP * t);
+    }
+
+    *outX = x;
+    *outDX = dx;
+}
+
+// The spring is at rest once it's close enough to the end and moving too
+// slowly to get visibly further away before the next frame.
+static bool XNCoreSpringResting(double x, double dx, double restDistance, double restVelocity) {
+    return (fabs(x) <= restDistance && fabs(dx) <= restVelocity);
+}
+
+double XNCoreSpringEvaluate(const XNCoreSpring *spring, double elapsed, double velocity, double restDistance, double restVelocity, bool *complete) {
+    double x, dx;
+    XNCoreSpringSolve(spring, 1.0, -velocity, elapsed, &x, &dx);
+
+    if (XNCoreSpringResting(x, dx, restDistance, restVelocity)) {
+        *complete = true;
+        return 1.0;
+    } else {
+        *complete = false;
+        return 1.0 - x;
+    }
+}
+
+void XNCoreSpringEvaluateBatch(const XNCoreSpring *spring, size_t count, double elapsed, const double *velocities, const double *from, const double *to, double restDistance, double restVelocity, double *positions, bool *complete) {
+    bool all = true;
+
+    for (size_t i = 0; i < count; i++) {
+        double velocity, distance, speed;
+        bool done = false;
+
+        if (XNCoreTimingNormalize(from[i], to[i], velocities[i], restDistance, restVelocity, &velocity, &distance, &speed)) {
+            double x = XNCoreSpringEvaluate(spring, elapsed, velocity, distance, speed, &done);
+            positions[i] = from[i] + x * (to[i] - from[i]);
+        } else {
+            // Already on the target, but a velocity still carries it away and
+            // back, so simulate that in the units of the components.
+            double x, dx;
+            XNCoreSpringSolve(spring, 0.0, -velocity, elapsed, &x, &dx);
+
+            done = XNCoreSpringResting(x, dx, distance, speed);
+            positions[i] = (done ? to[i] : to[i] - x);
+        }
+
+        all = (all && done);
+    }
+
+    if (complete != NULL) {
+        *complete = all;
+    }
+}
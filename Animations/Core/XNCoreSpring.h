@@ -0,0 +1,33 @@
+//
+//  XNCoreSpring.h
+//  Animations
+//
+//  Created by Grant Paul on 1/19/13.
+//  Copyright (c) 2013 Xuzz Productions, LLC. All rights reserved.
+//
+
+#ifndef XN_CORE_SPRING_H
+#define XN_CORE_SPRING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A damped harmonic oscillator, solved analytically.
+typedef struct XNCoreSpring {
+    double tension;
+    double damping;
+    double mass;
+} XNCoreSpring;
+
+double XNCoreSpringEvaluate(const XNCoreSpring *spring, double elapsed, double velocity, double restDistance, double restVelocity, bool *complete);
+void XNCoreSpringEvaluateBatch(const XNCoreSpring *spring, size_t count, double elapsed, const double *velocities, const double *from, const double *to, double restDistance, double restVelocity, double *positions, bool *complete);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
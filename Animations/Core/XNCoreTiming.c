@@ -0,0 +1,79 @@
+//
+//  XNCoreTiming.c
+//  Animations
+//
+//  Created by Grant Paul on 1/19/13.
+//  Copyright (c) 2013 Xuzz Productions, LLC. All rights reserved.
+//
+
+#include <math.h>
+
+#include "XNCoreTiming.h"
+
+bool XNCoreTimingNormalize(double from, double to, double velocity, double restDistance, double restVelocity, double *outVelocity, double *outRestDistance, double *outRestVelocity) {
+    double range = (to - from);
+
+    if (range == 0) {
+        *outVelocity = velocity;
+        *outRestDistance = restDistance;
+        *outRestVelocity = restVelocity;
+        return false;
+    } else {
+        *outVelocity = velocity / range;
+        *outRestDistance = restDistance / fabs(range);
+        *outRestVelocity = restVelocity / fabs(range);
+        return true;
+    }
+}
+
+double XNCoreStepEvaluate(double t, bool *complete) {
+    if (t >= 1.0) {
+        *complete = true;
+        return 1.0;
+    } else {
+        *complete = false;
+        return 0.0;
+    }
+}
+
+void XNCoreStepEvaluateBatch(size_t count, double elapsed, const double *durations, const double *from, const double *to, double *positions, bool *complete) {
+    bool all = true;
+
+    for (size_t i = 0; i < count; i++) {
+        bool done = false;
+        double x = XNCoreStepEvaluate(elapsed / durations[i], &done);
+
+        positions[i] = from[i] + x * (to[i] - from[i]);
+        all = (all && done);
+    }
+
+    if (complete != NULL) {
+        *complete = all;
+    }
+}
+
+double XNCoreLinearEvaluate(double t, bool *complete) {
+    if (t >= 1.0) {
+        *complete = true;
+        return 1.0;
+    } else {
+        *complete = false;
+        return t;
+    }
+}
+
+void XNCoreLinearEvaluateBatch(size_t count, double elapsed, const double *durations, const double *from, const double *to, double *positions, bool *complete) {
+    bool all = true;
+
+    for (size_t i = 0; i < count; i++) {
+        bool done = false;
+        double x = XNCoreLinearEvaluate(elapsed / durations[i], &done);
+
+        positions[i] = from[i] + x * (to[i] - from[i]);
+        all = (all && done);
+    }
+
+    if (complete != NULL) {
+        *complete = all;
+    }
+}
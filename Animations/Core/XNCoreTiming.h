@@ -0,0 +1,45 @@
+//
+//  XNCoreTiming.h
+//  Animations
+//
+//  Created by Grant Paul on 1/19/13.
+//  Copyright (c) 2013 Xuzz Productions, LLC. All rights reserved.
+//
+
+#ifndef XN_CORE_TIMING_H
+#define XN_CORE_TIMING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The timing math used by the XNTimingFunction classes, with no dependencies
+// beyond the C library. Scalar functions work in normalized positions, where 0
+// is the from value and 1 is the to value. Batch functions take one entry per
+// component and write absolute positions; complete is set if all of them are.
+//
+// Duration-based functions take t = elapsed / duration. Velocity-based ones
+// take velocities and rest thresholds normalized to the range (see below), with
+// velocities per second.
+
+// Converts a velocity and rest thresholds in the units of the components into
+// ones normalized to the range. With nothing to move there's no range to
+// normalize against, so the values are left as they are and false is returned;
+// callers then simulate in the units of the components instead.
+bool XNCoreTimingNormalize(double from, double to, double velocity, double restDistance, double restVelocity, double *outVelocity, double *outRestDistance, double *outRestVelocity);
+
+// Jumps to the end once the duration has passed.
+double XNCoreStepEvaluate(double t, bool *complete);
+void XNCoreStepEvaluateBatch(size_t count, double elapsed, const double *durations, const double *from, const double *to, double *positions, bool *complete);
+
+double XNCoreLinearEvaluate(double t, bool *complete);
+void XNCoreLinearEvaluateBatch(size_t count, double elapsed, const double *durations, const double *from, const double *to, double *positions, bool *complete);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,124 @@
+//
+//  XNCoreTrace.c
+//  Animations
+//
+//  Created by Grant Paul on 1/19/13.
+//  Copyright (c) 2013 Xuzz Productions, LLC. All rights reserved.
+//
+
+#include <string.h>
+
+#include "XNCoreTrace.h"
+
+// Records aren't aligned, so everything is copied out.
+static bool XNCoreTraceReaderRead(XNCoreTraceReader *reader, void *bytes, size_t length) {
+    if (reader->length - reader->position < length) {
+        return false;
+    }
+
+    memcpy(bytes, reader->bytes + reader->position, length);
+    reader->position += length;
+
+    return true;
+}
+
+XNCoreTraceStatus XNCoreTraceReaderInit(XNCoreTraceReader *reader, const void *bytes, size_t length) {
+    reader->bytes = bytes;
+    reader->length = length;
+    reader->position = 0;
+
+    char magic[4];
+    uint32_t version;
+
+    if (!XNCoreTraceReaderRead(reader, magic, sizeof(magic)) || !XNCoreTraceReaderRead(reader, &version, sizeof(version))) {
+        return XNCoreTraceStatusTruncated;
+    }
+
+    if (memcmp(magic, "XNTR", 4) != 0 || version != XNCoreTraceVersion) {
+        return XNCoreTraceStatusInvalid;
+    }
+
+    return XNCoreTraceStatusRecord;
+}
+
+XNCoreTraceStatus XNCoreTraceReaderNext(XNCoreTraceReader *reader, XNCoreTraceRecord *record) {
+    if (reader->position == reader->length) {
+        return XNCoreTraceStatusEnd;
+    }
+
+    memset(record, 0, sizeof(*record));
+
+    if (!XNCoreTraceReaderRead(reader, &record->type, sizeof(record->type)) || !XNCoreTraceReaderRead(reader, &record->timestamp, sizeof(record->timestamp))) {
+        return XNCoreTraceStatusTruncated;
+    }
+
+    bool read = true;
+
+    if (record->type == XNCoreTraceRecordTypeConfiguration) {
+        read = XNCoreTraceReaderRead(reader, &record->flags, sizeof(record->flags)) && XNCoreTraceReaderRead(reader, record->values, (sizeof(float) * 3));
+
+        // Rest thresholds are divided by the screen scale.
+        if (read && !(record->values[2] > 0)) {
+            return XNCoreTraceStatusInvalid;
+        }
+    } else if (record->type == XNCoreTraceRecordTypeGeometry) {
+        read = XNCoreTraceReaderRead(reader, record->values, (sizeof(float) * 10));
+    } else if (record->type == XNCoreTraceRecordTypePan) {
+        read = XNCoreTraceReaderRead(reader, &record->state, sizeof(record->state)) && XNCoreTraceReaderRead(reader, record->values, (sizeof(float) * 2));
+    } else if (record->type != XNCoreTraceRecordTypeTick) {
+        return XNCoreTraceStatusInvalid;
+    }
+
+    return (read ? XNCoreTraceStatusRecord : XNCoreTraceStatusTruncated);
+}
+
+void XNCoreTraceReplayInit(XNCoreTraceReplay *replay, XNCoreScroll *scroll) {
+    replay->scroll = scroll;
+    replay->ticked = false;
+    replay->previous = 0;
+}
+
+bool XNCoreTraceReplayRecord(XNCoreTraceReplay *replay, const XNCoreTraceRecord *record) {
+    XNCoreScroll *scroll = replay->scroll;
+
+    if (record->type == XNCoreTraceRecordTypeConfiguration) {
+        scroll->bounces = ((record->flags & XNCoreTraceFlagBounces) != 0);
+        scroll->alwaysBounceHorizontal = ((record->flags & XNCoreTraceFlagAlwaysBounceHorizontal) != 0);
+        scroll->alwaysBounceVertical = ((record->flags & XNCoreTraceFlagAlwaysBounceVertical) != 0);
+        scroll->predictsTouches = ((record->flags & XNCoreTraceFlagPredictsTouches) != 0);
+        scroll->elasticSimpleFormula = ((record->flags & XNCoreTraceFlagElasticSimpleFormula) != 0);
+        scroll->decelerationRate = record->values[0];
+        scroll->elasticConstant = record->values[1];
+        XNCoreScrollSetScreenScale(scroll, record->values[2]);
+    } else if (record->type == XNCoreTraceRecordTypeGeometry) {
+        scroll->boundsWidth = record->values[2];
+        scroll->boundsHeight = record->values[3];
+        scroll->contentWidth = record->values[4];
+        scroll->contentHeight = record->values[5];
+        scroll->insetTop = record->values[6];
+        scroll->insetLeft = record->values[7];
+        scroll->insetBottom = record->values[8];
+        scroll->insetRight = record->values[9];
+        XNCoreScrollGeometryChanged(scroll);
+
+        // The bounds origin is the content offset as it was recorded.
+        scroll->contentOffset.x = record->values[0];
+        scroll->contentOffset.y = record->values[1];
+    } else if (record->type == XNCoreTraceRecordTypePan) {
+        XNCoreScrollPoint translation = { record->values[0], record->values[1] };
+        XNCoreScrollPan(scroll, record->state, translation, record->timestamp, record->timestamp);
+    } else if (record->type == XNCoreTraceRecordTypeTick) {
+        bool frame = replay->ticked;
+
+        if (frame) {
+            XNCoreScrollStep(scroll, (record->timestamp - replay->previous));
+        }
+
+        replay->ticked = true;
+        replay->previous = record->timestamp;
+
+        return frame;
+    }
+
+    return false;
+}
@@ -0,0 +1,104 @@
+//
+//  XNCoreTrace.h
+//  Animations
+//
+//  Created by Grant Paul on 1/19/13.
+//  Copyright (c) 2013 Xuzz Productions, LLC. All rights reserved.
+//
+
+#ifndef XN_CORE_TRACE_H
+#define XN_CORE_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "XNCoreScroll.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Scrolling traces, as written by XNTraceRecorder. All values are in host byte
+// order. Timestamps are media time (see CACurrentMediaTime()).
+//
+// header:        'X' 'N' 'T' 'R', uint32 version
+// configuration: uint8 type, double timestamp, uint8 flags,
+//                float deceleration rate, elastic constant, screen scale
+// geometry:      uint8 type, double timestamp, float bounds x, y, width, height,
+//                float content width, height, float inset top, left, bottom, right
+// pan:           uint8 type, double timestamp, uint8 state, float translation x, y
+// tick:          uint8 type, double timestamp
+//
+// Recording starts with a configuration, so the physics replay as they were
+// set up on the device.
+
+enum { XNCoreTraceVersion = 2 };
+
+enum {
+    XNCoreTraceRecordTypeGeometry = 1,
+    XNCoreTraceRecordTypePan = 2,
+    XNCoreTraceRecordTypeTick = 3,
+    XNCoreTraceRecordTypeConfiguration = 4
+};
+
+// Configuration flags.
+enum {
+    XNCoreTraceFlagBounces = 1 << 0,
+    XNCoreTraceFlagAlwaysBounceHorizontal = 1 << 1,
+    XNCoreTraceFlagAlwaysBounceVertical = 1 << 2,
+    XNCoreTraceFlagPredictsTouches = 1 << 3,
+    XNCoreTraceFlagElasticSimpleFormula = 1 << 4
+};
+
+typedef struct XNCoreTraceRecord {
+    uint8_t type;
+    double timestamp;
+    uint8_t state; // pan only, see XNCoreScrollPanState
+    uint8_t flags; // configuration only
+    float values[10]; // the floats of the record, in order
+} XNCoreTraceRecord;
+
+enum {
+    XNCoreTraceStatusRecord, // a record was read
+    XNCoreTraceStatusEnd,
+    XNCoreTraceStatusTruncated, // ended inside a record
+    XNCoreTraceStatusInvalid // not a trace, an unsupported version, or an unknown or impossible record
+};
+
+typedef int XNCoreTraceStatus;
+
+// Reads records in place from a trace; the bytes must outlive the reader.
+typedef struct XNCoreTraceReader {
+    const uint8_t *bytes;
+    size_t length;
+    size_t position;
+} XNCoreTraceReader;
+
+// Reads the header. Returns XNCoreTraceStatusRecord if it's a readable trace.
+XNCoreTraceStatus XNCoreTraceReaderInit(XNCoreTraceReader *reader, const void *bytes, size_t length);
+XNCoreTraceStatus XNCoreTraceReaderNext(XNCoreTraceReader *reader, XNCoreTraceRecord *record);
+
+// Replays records into a scroll model, in place of the scroll view and display
+// link they were recorded from. The configuration replaces the model's, ticks
+// step deceleration by the recorded frame timing, and predicted touches are
+// measured against the time of each event, so a trace always replays the same
+// way.
+typedef struct XNCoreTraceReplay {
+    XNCoreScroll *scroll;
+    bool ticked;
+    double previous; // timestamp of the last tick
+} XNCoreTraceReplay;
+
+void XNCoreTraceReplayInit(XNCoreTraceReplay *replay, XNCoreScroll *scroll);
+
+// Returns true for a tick after the first (which has no previous frame to time
+// from, just as the display link's doesn't); the scroll model then has the
+// content offset for that frame.
+bool XNCoreTraceReplayRecord(XNCoreTraceReplay *replay, const XNCoreTraceRecord *record);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
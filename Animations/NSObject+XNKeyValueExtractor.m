@@ -12,18 +12,12 @@
 
 @implementation NSObject (XNKeyValueExtractor)
 
-static XNKeyValueExtractor *keyValueExtractor = nil;
-
-__attribute__((constructor)) static void NSObjectXNKeyValueExtractorInitialize() {
-    keyValueExtractor = [[XNKeyValueExtractor alloc] init];
-}
-
 - (id)valueForXNKeyPath:(NSString *)keyPath {
-    return [keyValueExtractor object:self valueForKeyPath:keyPath];
+    return [[XNKeyValueExtractor sharedExtractor] object:self valueForKeyPath:keyPath];
 }
 
 - (void)setValue:(id)value forXNKeyPath:(NSString *)keyPath {
-    [keyValueExtractor object:self setValue:value forKeyPath:keyPath];
+    [[XNKeyValueExtractor sharedExtractor] object:self setValue:value forKeyPath:keyPath];
 }
 
 @end
@@ -7,8 +7,20 @@
 //
 
 @class XNTimingFunction;
+@class XNAnimationFrame;
 @protocol XNAnimationDelegate;
 
+// When the animation link runs over its frame budget, interactive animations
+// still update every frame, standard animations skip frames and catch up
+// later, and decorative animations jump to their end.
+enum {
+    XNAnimationPriorityInteractive,
+    XNAnimationPriorityStandard,
+    XNAnimationPriorityDecorative
+};
+
+typedef NSInteger XNAnimationPriority;
+
 @interface XNAnimation : NSObject
 
 + (id)animation;
@@ -19,7 +31,7 @@
 - (id)initWithKeyPath:(NSString *)keyPath;
 
 @property (nonatomic, copy) NSString *keyPath; // required
-@property (nonatomic, retain) XNTimingFunction *timingFunction; // required, default bezier
+@property (nonatomic, retain) XNTimingFunction *timingFunction; // required, default ease in-out bezier (shared and immutable, so replace it rather than changing it)
 
 @property (nonatomic, assign) NSTimeInterval duration; // required, cannot set velocity
 @property (nonatomic, copy) id velocity; // required, cannot set duration
@@ -27,6 +39,12 @@
 @property (nonatomic, copy) id fromValue; // optional, default current state
 @property (nonatomic, copy) id toValue; // required
 
+// Velocity-based timing functions stop once the value is within the rest
+// distance of the target and changing slower than the rest velocity.
+@property (nonatomic, assign) CGFloat restDistance; // optional, default half a pixel; 1/255 for colors and alpha
+@property (nonatomic, assign) CGFloat restVelocity; // optional, per second, default rest distance per frame at 60Hz
+
+@property (nonatomic, assign) XNAnimationPriority priority; // default standard
 @property (nonatomic, assign, getter=isRemovedOnCompletion) BOOL removedOnCompletion; // default YES
 @property (nonatomic, assign) id<XNAnimationDelegate> delegate; // optional, default nil
 
@@ -48,7 +66,20 @@
 - (BOOL)active;
 - (void)beginWithTarget:(id)target;
 - (void)simulateWithTimeInterval:(NSTimeInterval)dt;
+- (id)valueBySimulatingWithTimeInterval:(NSTimeInterval)dt; // does not apply the value
+- (void)didUpdate;
+- (NSUInteger)deferredFrames;
+- (void)deferWithTimeInterval:(NSTimeInterval)dt; // skip this frame
+- (void)finish; // apply the toValue and complete
+- (XNAnimationFrame *)prefetchFrameWithTimeInterval:(NSTimeInterval)dt; // nil if nothing to prefetch
 - (void)end;
 - (void)reset;
 
 @end
+
+// Simulation results for an upcoming frame, computed ahead of time.
+@interface XNAnimationFrame : NSObject
+
+- (void)evaluate; // safe to call from any thread
+
+@end
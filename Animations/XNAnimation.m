@@ -6,41 +6,234 @@
 //  Copyright (c) 2012 Xuzz Productions, LLC. All rights reserved.
 //
 
+#import <libkern/OSAtomic.h>
+
 #import "XNAnimation.h"
+#import "XNAnimationLink.h"
+#import "XNAnimationState.h"
 
 #import "XNKeyValueExtractor.h"
 #import "XNBezierTimingFunction.h"
 
 const NSTimeInterval kXNAnimationDefaultDuration = 1.0;
 
-@implementation XNAnimation {
-    XNKeyValueExtractor *_extractor;
+// Default rest distances, by what's being animated. Positions and sizes rest
+// within half a device pixel, colors and alpha within one 8-bit step, and
+// unitless scales and rotations within a thousandth.
+const static CGFloat kXNAnimationRestDistancePixels = 0.5f;
+const static CGFloat kXNAnimationRestDistanceColor = 1.0f / 255.0f;
+const static CGFloat kXNAnimationRestDistanceUnitless = 0.001f;
+const static CGFloat kXNAnimationRestVelocityFrameRate = 60.0f;
+
+// How far a prefetched frame's elapsed time can be from the actual elapsed
+// time and still be used. The display link's timestamps are quantized to the
+// refresh rate, so on-time frames match exactly.
+const static NSTimeInterval kXNAnimationFrameElapsedTolerance = 0.001;
+
+enum {
+    XNAnimationFrameStateIdle,
+    XNAnimationFrameStatePending, // owned by the simulation queue
+    XNAnimationFrameStateReady
+};
+
+@interface XNAnimationFrame ()
+
+- (BOOL)prepareWithGeneration:(NSUInteger)generation elapsed:(NSTimeInterval)elapsed timeInterval:(NSTimeInterval)dt timingFunction:(XNTimingFunction *)timingFunction durations:(NSArray *)durations velocities:(NSArray *)velocities fromComponents:(NSArray *)fromComponents toComponents:(NSArray *)toComponents restDistance:(CGFloat)restDistance restVelocity:(CGFloat)restVelocity;
+- (NSArray *)positionsForGeneration:(NSUInteger)generation elapsed:(NSTimeInterval)elapsed complete:(BOOL *)outComplete;
+
+@end
+
+// Frames are filled in on the main thread, evaluated on the simulation queue,
+// then consumed on the main thread. The state is the only thing both touch
+// concurrently; the inputs are immutable while a frame is pending.
+@implementation XNAnimationFrame {
+    volatile int32_t _state;
+
+    NSUInteger _generation;
+    NSTimeInterval _elapsed;
+    NSTimeInterval _dt;
+
+    XNTimingFunction *_timingFunction;
+    NSArray *_durations;
+    NSArray *_velocities;
+    NSArray *_fromComponents;
+    NSArray *_toComponents;
+    CGFloat _restDistance;
+    CGFloat _restVelocity;
+
+    NSArray *_positions;
+    BOOL _complete;
+}
+
+- (void)dealloc {
+    [_timingFunction release];
+    [_durations release];
+    [_velocities release];
+    [_fromComponents release];
+    [_toComponents release];
+    [_positions release];
+
+    [super dealloc];
+}
+
+- (BOOL)prepareWithGeneration:(NSUInteger)generation elapsed:(NSTimeInterval)elapsed timeInterval:(NSTimeInterval)dt timingFunction:(XNTimingFunction *)timingFunction durations:(NSArray *)durations velocities:(NSArray *)velocities fromComponents:(NSArray *)fromComponents toComponents:(NSArray *)toComponents restDistance:(CGFloat)restDistance restVelocity:(CGFloat)restVelocity {
+    OSMemoryBarrier();
+
+    if (_state == XNAnimationFrameStatePending) {
+        return NO;
+    }
+
+    _generation = generation;
+    _elapsed = elapsed;
+    _dt = dt;
+    _restDistance = restDistance;
+    _restVelocity = restVelocity;
+
+    [_timingFunction release];
+    _timingFunction = [timingFunction retain];
+    [_durations release];
+    _durations = [durations retain];
+    [_velocities release];
+    _velocities = [velocities retain];
+    [_fromComponents release];
+    _fromComponents = [fromComponents retain];
+    [_toComponents release];
+    _toComponents = [toComponents retain];
+
+    [_positions release];
+    _positions = nil;
+    _complete = NO;
+
+    OSMemoryBarrier();
+    _state = XNAnimationFrameStatePending;
+
+    return YES;
+}
+
+- (void)evaluate {
+    OSMemoryBarrier();
+
+    if (_state != XNAnimationFrameStatePending) {
+        return;
+    }
+
+    @autoreleasepool {
+        NSArray *positions = [_timingFunction simulateWithTimeInterval:_dt elapsed:_elapsed durations:_durations velocities:_velocities fromComponents:_fromComponents toComponents:_toComponents restDistance:_restDistance restVelocity:_restVelocity complete:&_complete];
+        _positions = [positions retain];
+    }
+
+    OSMemoryBarrier();
+    _state = XNAnimationFrameStateReady;
+}
+
+- (NSArray *)positionsForGeneration:(NSUInteger)generation elapsed:(NSTimeInterval)elapsed complete:(BOOL *)outComplete {
+    OSMemoryBarrier();
+
+    if (_state != XNAnimationFrameStateReady) {
+        return nil;
+    }
+
+    // Whether used or stale, a ready frame is free to be prepared again.
+    _state = XNAnimationFrameStateIdle;
+
+    if (_generation != generation || fabs(_elapsed - elapsed) > kXNAnimationFrameElapsedTolerance) {
+        return nil;
+    }
+
+    if (outComplete != NULL) {
+        *outComplete = _complete;
+    }
+
+    return [[_positions retain] autorelease];
+}
 
+- (BOOL)clear {
+    OSMemoryBarrier();
+
+    if (_state == XNAnimationFrameStatePending) {
+        return NO;
+    }
+
+    _state = XNAnimationFrameStateIdle;
+
+    [_timingFunction release];
+    _timingFunction = nil;
+    [_durations release];
+    _durations = nil;
+    [_velocities release];
+    _velocities = nil;
+    [_fromComponents release];
+    _fromComponents = nil;
+    [_toComponents release];
+    _toComponents = nil;
+
+    [_positions release];
+    _positions = nil;
+    _complete = NO;
+
+    return YES;
+}
+
+@end
+
+// The default timing function is shared by every animation that doesn't set
+// its own, so it can't be changed once set up. Copies are ordinary curves.
+@interface XNAnimationDefaultTimingFunction : XNBezierTimingFunction
+@end
+
+@implementation XNAnimationDefaultTimingFunction {
+    BOOL _immutable;
+}
+
+- (id)init {
+    if ((self = [super init])) {
+        _immutable = YES;
+    }
+
+    return self;
+}
+
+- (void)setControlPoints:(NSArray *)controlPoints {
+    if (_immutable) {
+        [NSException raise:@"XNAnimationImmutableTimingFunctionException" format:@"the default timing function is shared; set a new timing function instead"];
+    }
+
+    [super setControlPoints:controlPoints];
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    XNBezierTimingFunction *copy = [[XNBezierTimingFunction alloc] init];
+    [copy setControlPoints:[self controlPoints]];
+    return copy;
+}
+
+@end
+
+@implementation XNAnimation {
     // Configuration properties.
     NSString *_keyPath;
     id _fromValue;
     id _toValue;
     NSTimeInterval _duration;
     id _velocity;
+    CGFloat _restDistance;
+    CGFloat _restVelocity;
     XNTimingFunction *_timingFunction;
+    XNAnimationPriority _priority;
     BOOL _removedOnCompletion;
     id<XNAnimationDelegate> _delegate;
     BOOL _delegateWantsProgress;
 
-    // State-dependent properties.
-    id _target;
     BOOL _completed;
-    NSTimeInterval _elapsed;
 
-    NSArray *_durations;
-    NSArray *_velocities;
-    NSArray *_toComponents;
-    NSArray *_fromComponents;
+    // Everything else is only needed while running.
+    XNAnimationState *_state;
 }
 
 #pragma mark - Properties
 
 @synthesize keyPath = _keyPath;
+@synthesize priority = _priority;
 @synthesize removedOnCompletion = _removedOnCompletion;
 @synthesize completed = _completed;
 @synthesize delegate = _delegate;
@@ -51,6 +244,19 @@ const NSTimeInterval kXNAnimationDefaultDuration = 1.0;
 @synthesize timingFunction = _timingFunction;
 @synthesize duration = _duration;
 @synthesize velocity = _velocity;
+@synthesize restDistance = _restDistance;
+@synthesize restVelocity = _restVelocity;
+
+- (void)setKeyPath:(NSString *)keyPath {
+    [_keyPath release];
+    _keyPath = [keyPath copy];
+
+    if (_state != NULL) {
+        _state->restDistance = NAN;
+    }
+
+    [self invalidateFrames];
+}
 
 - (void)setFromValue:(id)fromValue {
     [_fromValue release];
@@ -61,8 +267,12 @@ const NSTimeInterval kXNAnimationDefaultDuration = 1.0;
         _fromValue = [fromValue retain];
     }
 
-    [_fromComponents release];
-    _fromComponents = nil;
+    if (_state != NULL) {
+        [_state->fromComponents release];
+        _state->fromComponents = nil;
+    }
+
+    [self invalidateFrames];
 }
 
 - (void)setToValue:(id)toValue {
@@ -74,15 +284,30 @@ const NSTimeInterval kXNAnimationDefaultDuration = 1.0;
         _toValue = [toValue retain];
     }
 
-    [_toComponents release];
-    _toComponents = nil;
+    // Durations are per component, so they depend on the value too.
+    if (_state != NULL) {
+        [_state->toComponents release];
+        _state->toComponents = nil;
+        [_state->durations release];
+        _state->durations = nil;
+        _state->restDistance = NAN;
+    }
+
+    [self invalidateFrames];
 }
 
 - (void)setDuration:(NSTimeInterval)duration {
     _duration = duration;
 
-    [_durations release];
-    _durations = nil;
+    // Clear both so setting both is still caught when extracting.
+    if (_state != NULL) {
+        [_state->durations release];
+        _state->durations = nil;
+        [_state->velocities release];
+        _state->velocities = nil;
+    }
+
+    [self invalidateFrames];
 }
 
 - (void)setVelocity:(id)velocity {
@@ -94,8 +319,47 @@ const NSTimeInterval kXNAnimationDefaultDuration = 1.0;
         _velocity = [velocity retain];
     }
 
-    [_velocities release];
-    _velocities = nil;
+    if (_state != NULL) {
+        [_state->velocities release];
+        _state->velocities = nil;
+        [_state->durations release];
+        _state->durations = nil;
+    }
+
+    [self invalidateFrames];
+}
+
+- (void)setRestDistance:(CGFloat)restDistance {
+    _restDistance = restDistance;
+
+    if (_state != NULL) {
+        _state->restDistance = NAN;
+    }
+
+    [self invalidateFrames];
+}
+
+- (void)setRestVelocity:(CGFloat)restVelocity {
+    _restVelocity = restVelocity;
+
+    if (_state != NULL) {
+        _state->restDistance = NAN;
+    }
+
+    [self invalidateFrames];
+}
+
+- (void)setTimingFunction:(XNTimingFunction *)timingFunction {
+    [timingFunction retain];
+    [_timingFunction release];
+    _timingFunction = timingFunction;
+
+    if (_state != NULL) {
+        [_state->timingFunction release];
+        _state->timingFunction = nil;
+    }
+
+    [self invalidateFrames];
 }
 
 #pragma mark - Lifecycle
@@ -106,6 +370,18 @@ const NSTimeInterval kXNAnimationDefaultDuration = 1.0;
     _delegateWantsProgress = [_delegate respondsToSelector:@selector(animationUpdated:)];
 }
 
++ (XNTimingFunction *)defaultTimingFunction {
+    static XNTimingFunction *defaultTimingFunction = nil;
+
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        // Already ease in-out, like any new bezier timing function.
+        defaultTimingFunction = [[XNAnimationDefaultTimingFunction alloc] init];
+    });
+
+    return defaultTimingFunction;
+}
+
 + (id)animation {
     XNAnimation *animation = [[[self alloc] init] autorelease];
     return animation;
@@ -143,9 +419,11 @@ const NSTimeInterval kXNAnimationDefaultDuration = 1.0;
 - (id)init {
     if ((self = [super init])) {
         _duration = NAN;
+        _restDistance = NAN;
+        _restVelocity = NAN;
         _removedOnCompletion = YES;
-        _extractor = [[XNKeyValueExtractor alloc] init];
-        _timingFunction = [[XNBezierTimingFunction timingFunctionWithControlPoints:[XNBezierTimingFunction controlPointsEaseInOut]] retain];
+        _priority = XNAnimationPriorityStandard;
+        _timingFunction = [[[self class] defaultTimingFunction] retain];
     }
 
     return self;
@@ -154,7 +432,7 @@ const NSTimeInterval kXNAnimationDefaultDuration = 1.0;
 - (void)dealloc {
     [self reset];
     
-    [_extractor release];
+    [_keyPath release];
     [_timingFunction release];
 
     [_toValue release];
@@ -170,38 +448,75 @@ const NSTimeInterval kXNAnimationDefaultDuration = 1.0;
 
 #pragma mark - Animation
 
+- (BOOL)valueIsColor:(id)value {
+    if (value == nil) {
+        return NO;
+    } else if ([value isKindOfClass:[UIColor class]]) {
+        return YES;
+    } else if ([value isKindOfClass:[NSValue class]] || [value isKindOfClass:[NSArray class]]) {
+        return NO;
+    } else {
+        // Not one of the Objective-C values, so it could be a CGColorRef.
+        return (CFGetTypeID((CFTypeRef) value) == CGColorGetTypeID());
+    }
+}
+
+// Scales and rotations of layer transforms, like transform.scale.x or
+// transform.rotation, rather than any key path that mentions them.
+- (BOOL)keysAreUnitless:(NSArray *)keys {
+    NSString *key = [keys lastObject];
+
+    if ([keys count] >= 2 && ([key isEqualToString:@"x"] || [key isEqualToString:@"y"] || [key isEqualToString:@"z"])) {
+        key = [keys objectAtIndex:([keys count] - 2)];
+    }
+
+    return ([key isEqualToString:@"scale"] || [key isEqualToString:@"rotation"]);
+}
+
+- (CGFloat)defaultRestDistance {
+    NSArray *keys = [_keyPath componentsSeparatedByString:@"."];
+    NSString *key = [keys lastObject];
+
+    if ([self valueIsColor:_toValue]) {
+        return kXNAnimationRestDistanceColor;
+    } else if ([key isEqualToString:@"alpha"] || [key isEqualToString:@"opacity"]) {
+        return kXNAnimationRestDistanceColor;
+    } else if ([self keysAreUnitless:keys]) {
+        return kXNAnimationRestDistanceUnitless;
+    } else {
+        return kXNAnimationRestDistancePixels / [[UIScreen mainScreen] scale];
+    }
+}
+
 - (void)extractUpdatedParameters {
-    if (_toComponents == nil) {
+    XNKeyValueExtractor *extractor = [XNKeyValueExtractor sharedExtractor];
+
+    if (_state->toComponents == nil) {
         if (_toValue == nil) {
             [NSException raise:@"XNAnimationInvalidParameterException" format:@"you must specify a toValue"];
         }
     
-        _toComponents = [[_extractor componentsForObject:_toValue] retain];
+        _state->toComponents = [[extractor componentsForObject:_toValue] retain];
     }
 
-    if (_fromComponents == nil) {
-        NSValue *fromValue = _fromValue;
-        if (fromValue == nil) {
-            fromValue = [_extractor object:_target valueForKeyPath:_keyPath];
+    if (_state->fromComponents == nil) {
+        id fromValue = _fromValue;
 
-            if ([fromValue respondsToSelector:@selector(copyWithZone:)]) {
-                fromValue = [fromValue copy];
-            } else {
-                fromValue = [fromValue retain];
-            }
+        if (fromValue == nil) {
+            fromValue = [extractor object:_state->target valueForKeyPath:_keyPath];
         }
 
-        _fromComponents = [[_extractor componentsForObject:fromValue] retain];
+        _state->fromComponents = [[extractor componentsForObject:fromValue] retain];
     }
 
-    if (_velocities == nil && _durations == nil) {
+    if (_state->velocities == nil && _state->durations == nil) {
         if (_velocity != nil && !isnan(_duration)) {
             [NSException raise:@"XNAnimationInvalidParameterException" format:@"you cannot specify both a duration and a velocity"];
         }
 
         if (_velocity != nil) {
-            NSArray *componentValues = [_extractor componentsForObject:_velocity];
-            _velocities = [componentValues retain];
+            NSArray *componentValues = [extractor componentsForObject:_velocity];
+            _state->velocities = [componentValues retain];
         } else if (!isnan(_duration)) {
             NSTimeInterval effectiveDuration = _duration;
 
@@ -211,19 +526,41 @@ const NSTimeInterval kXNAnimationDefaultDuration = 1.0;
 
             NSMutableArray *durations = [NSMutableArray array];
 
-            for (NSUInteger i = 0; i < [_toComponents count]; i++) {
+            for (NSUInteger i = 0; i < [_state->toComponents count]; i++) {
                 NSNumber *number = [NSNumber numberWithDouble:effectiveDuration];
                 [durations addObject:number];
             }
 
-            _durations = [durations retain];
+            _state->durations = [durations retain];
+        }
+    }
+
+    if (isnan(_state->restDistance)) {
+        _state->restDistance = _restDistance;
+
+        if (isnan(_state->restDistance)) {
+            _state->restDistance = [self defaultRestDistance];
+        }
+
+        _state->restVelocity = _restVelocity;
+
+        if (isnan(_state->restVelocity)) {
+            _state->restVelocity = _state->restDistance * kXNAnimationRestVelocityFrameRate;
         }
     }
 }
 
 - (void)beginWithTarget:(id)target {
     _completed = NO;
-    _target = target;
+
+    if (_state == NULL) {
+        _state = [[XNAnimationLink sharedInstance] acquireAnimationState];
+    }
+
+    _state->target = target;
+    _state->finished = NO;
+
+    [self invalidateFrames];
 
     [self extractUpdatedParameters];
 
@@ -232,21 +569,140 @@ const NSTimeInterval kXNAnimationDefaultDuration = 1.0;
     }
 }
 
-- (void)simulateWithTimeInterval:(NSTimeInterval)dt {
-    _elapsed += dt;
+- (id)valueBySimulatingWithTimeInterval:(NSTimeInterval)dt {
+    if (_state == NULL) {
+        return nil;
+    }
+
+    if (_state->finished) {
+        return _toValue;
+    }
+
+    dt += _state->deferredTime;
+    _state->deferredTime = 0;
+    _state->deferredFrames = 0;
+
+    _state->elapsed += dt;
+
+    [self extractUpdatedParameters];
+    [self checkSimulationTimingFunction];
+
+    NSArray *positions = nil;
+
+    for (NSUInteger i = 0; i < 2; i++) {
+        NSArray *prefetched = [_state->frames[i] positionsForGeneration:_state->generation elapsed:_state->elapsed complete:&_completed];
+
+        if (prefetched != nil) {
+            positions = prefetched;
+        }
+    }
+
+    if (positions == nil) {
+        // Not prefetched, or the prefetch was late: simulate synchronously.
+        positions = [_timingFunction simulateWithTimeInterval:dt elapsed:_state->elapsed durations:_state->durations velocities:_state->velocities fromComponents:_state->fromComponents toComponents:_state->toComponents restDistance:_state->restDistance restVelocity:_state->restVelocity complete:&_completed];
+    }
+
+    id value = [[XNKeyValueExtractor sharedExtractor] objectFromComponents:positions templateObject:_toValue];
+    return value;
+}
+
+- (XNAnimationFrame *)prefetchFrameWithTimeInterval:(NSTimeInterval)dt {
+    if (![self active] || _completed) {
+        return nil;
+    }
+
+    // If this frame was deferred, the next one will catch up.
+    dt += _state->deferredTime;
 
     [self extractUpdatedParameters];
+    [self checkSimulationTimingFunction];
 
-    NSArray *positions = [_timingFunction simulateWithTimeInterval:dt elapsed:_elapsed durations:_durations velocities:_velocities fromComponents:_fromComponents toComponents:_toComponents complete:&_completed];
+    // The timing function is copied so the simulation queue never sees it
+    // change underneath it.
+    if (_state->timingFunction == nil) {
+        _state->timingFunction = [_timingFunction copy];
+        _state->timingFunctionMutations = [_timingFunction mutations];
+    }
+
+    for (NSUInteger i = 0; i < 2; i++) {
+        if (_state->frames[i] == nil) {
+            _state->frames[i] = [[XNAnimationFrame alloc] init];
+        }
+
+        if ([_state->frames[i] prepareWithGeneration:_state->generation elapsed:(_state->elapsed + dt) timeInterval:dt timingFunction:_state->timingFunction durations:_state->durations velocities:_state->velocities fromComponents:_state->fromComponents toComponents:_state->toComponents restDistance:_state->restDistance restVelocity:_state->restVelocity]) {
+            return _state->frames[i];
+        }
+    }
+
+    // Both frames are still being evaluated; don't queue up more work.
+    return nil;
+}
 
-    id value = [_extractor objectFromComponents:positions templateObject:_toValue];
-    [_extractor object:_target setValue:value forKeyPath:_keyPath];
+// The timing function can be changed in place rather than through
+// -setTimingFunction:, so drop the copy (and anything prefetched with it) if
+// it no longer matches.
+- (void)checkSimulationTimingFunction {
+    if (_state->timingFunction != nil && _state->timingFunctionMutations != [_timingFunction mutations]) {
+        [_state->timingFunction release];
+        _state->timingFunction = nil;
 
+        [self invalidateFrames];
+    }
+}
+
+- (void)invalidateFrames {
+    if (_state != NULL) {
+        _state->generation += 1;
+    }
+}
+
+- (void)didUpdate {
     if (_delegateWantsProgress) {
         [_delegate animationUpdated:self];
     }
 }
 
+- (NSUInteger)deferredFrames {
+    if (_state == NULL) {
+        return 0;
+    }
+
+    return _state->deferredFrames;
+}
+
+- (void)deferWithTimeInterval:(NSTimeInterval)dt {
+    if (_state == NULL) {
+        return;
+    }
+
+    _state->deferredTime += dt;
+    _state->deferredFrames += 1;
+}
+
+- (void)finish {
+    if (_state == NULL) {
+        return;
+    }
+
+    _state->finished = YES;
+    _completed = YES;
+
+    [[XNKeyValueExtractor sharedExtractor] object:_state->target setValue:_toValue forKeyPath:_keyPath];
+
+    [self didUpdate];
+}
+
+- (void)simulateWithTimeInterval:(NSTimeInterval)dt {
+    if (_state == NULL) {
+        return;
+    }
+
+    id value = [self valueBySimulatingWithTimeInterval:dt];
+    [[XNKeyValueExtractor sharedExtractor] object:_state->target setValue:value forKeyPath:_keyPath];
+
+    [self didUpdate];
+}
+
 - (void)end {
     if ([_delegate respondsToSelector:@selector(animationStopped:)]) {
         [_delegate animationStopped:self];
@@ -256,21 +712,14 @@ const NSTimeInterval kXNAnimationDefaultDuration = 1.0;
 }
 
 - (BOOL)active {
-    return _target != nil;
+    return _state != NULL;
 }
 
 - (void)reset {
-    _elapsed = 0;
-    _target = nil;
-
-    [_fromComponents release];
-    _fromComponents = nil;
-    [_toComponents release];
-    _toComponents = nil;
-    [_durations release];
-    _durations = nil;
-    [_velocities release];
-    _velocities = nil;
+    if (_state != NULL) {
+        [[XNAnimationLink sharedInstance] relinquishAnimationState:_state];
+        _state = NULL;
+    }
 }
 
 @end
@@ -7,11 +7,24 @@
 //
 
 @class XNAnimation;
+struct XNAnimationState;
 
 @interface XNAnimationLink : NSObject
 
 + (id)sharedInstance;
 
+// Simulate the next frame on a background queue while the main thread is idle.
+// Defaults to YES on devices with more than one core.
+@property (nonatomic, assign) BOOL prefetchesSimulation;
+
+// Time each frame can spend simulating before lower priority animations are
+// degraded (see XNAnimationPriority). Defaults to half a frame at 60Hz.
+@property (nonatomic, assign) NSTimeInterval frameBudget;
+
+// How many frames in a row a standard priority animation can be skipped when
+// over budget before it has to update anyway. Defaults to 3.
+@property (nonatomic, assign) NSUInteger maximumDeferredFrames;
+
 - (void)addAnimation:(XNAnimation *)animation toObject:(id)object;
 - (BOOL)animation:(XNAnimation *)animation isAttachedToObject:(id)object;
 - (void)removeAnimation:(XNAnimation *)animation fromObject:(id)object;
@@ -20,3 +33,14 @@
 - (void)removeAnimationsFromObject:(id)object;
 
 @end
+
+@interface XNAnimationLink (Private)
+
+// Advances every active animation, as each display link frame does.
+- (void)simulateFrameWithTimeInterval:(NSTimeInterval)dt;
+
+// Runtime state for animations, recycled when they end.
+- (struct XNAnimationState *)acquireAnimationState;
+- (void)relinquishAnimationState:(struct XNAnimationState *)state;
+
+@end
@@ -10,15 +10,115 @@
 
 #import "XNAnimation.h"
 #import "XNAnimationLink.h"
+#import "XNAnimationState.h"
+#import "XNKeyValueExtractor.h"
+#import "XNTimingFunction.h"
+#import "XNTraceRecorder.h"
+
+// Animations on the same object whose key paths share a first component (such
+// as "frame.origin.x" and "frame.size.width") are applied together: the value
+// is read once, every animation is patched into it, and it is set once. That
+// keeps expensive setters like -setFrame: from running once per animation.
+static NSString *XNAnimationLinkRootKeyForKeyPath(NSString *keyPath) {
+    NSRange range = [keyPath rangeOfString:@"."];
+
+    if (range.location == NSNotFound) {
+        return keyPath;
+    } else {
+        return [keyPath substringToIndex:range.location];
+    }
+}
+
+static NSString *XNAnimationLinkRemainingKeyPathForKeyPath(NSString *keyPath) {
+    NSRange range = [keyPath rangeOfString:@"."];
+
+    if (range.location == NSNotFound) {
+        return nil;
+    } else {
+        return [keyPath substringFromIndex:(range.location + 1)];
+    }
+}
+
+// Animations on one object that share a root key, simulated together.
+@interface XNAnimationLinkGroup : NSObject
+
+- (id)initWithObject:(id)object rootKey:(NSString *)rootKey;
+@property (nonatomic, assign, readonly) id object;
+@property (nonatomic, copy, readonly) NSString *rootKey;
+
+- (void)addAnimation:(XNAnimation *)animation;
+@property (nonatomic, retain, readonly) NSArray *animations;
+@property (nonatomic, assign, readonly) XNAnimationPriority priority; // most urgent of the animations
+
+@end
+
+@implementation XNAnimationLinkGroup {
+    id _object;
+    NSString *_rootKey;
+    NSMutableArray *_animations;
+    XNAnimationPriority _priority;
+}
+
+@synthesize object = _object;
+@synthesize rootKey = _rootKey;
+@synthesize animations = _animations;
+@synthesize priority = _priority;
+
+- (id)initWithObject:(id)object rootKey:(NSString *)rootKey {
+    if ((self = [super init])) {
+        _object = object;
+        _rootKey = [rootKey copy];
+        _animations = [[NSMutableArray alloc] init];
+        _priority = XNAnimationPriorityDecorative;
+    }
+
+    return self;
+}
+
+- (void)dealloc {
+    [_rootKey release];
+    [_animations release];
+
+    [super dealloc];
+}
+
+- (void)addAnimation:(XNAnimation *)animation {
+    [_animations addObject:animation];
+    _priority = MIN(_priority, [animation priority]);
+}
+
+@end
+
+const static NSTimeInterval kXNAnimationLinkDefaultFrameBudget = (1.0 / 60.0) / 2.0;
+const static NSUInteger kXNAnimationLinkDefaultMaximumDeferredFrames = 3;
+
+// Animation states are allocated this many at a time. Ended states go on a
+// free list for the next animation to start, keeping only their emptied
+// frames. Blocks are never freed, so the pool only grows, to the most
+// animations ever running at once.
+enum { kXNAnimationLinkStateBlockCount = 32 };
 
 @implementation XNAnimationLink {
     CADisplayLink *_displayLink;
+    XNKeyValueExtractor *_extractor;
 
     NSMutableDictionary *_activeAnimations;
 
     NSTimeInterval _then;
+
+    BOOL _prefetchesSimulation;
+    dispatch_queue_t _simulationQueue;
+
+    NSTimeInterval _frameBudget;
+    NSUInteger _maximumDeferredFrames;
+
+    XNAnimationState *_freeStates;
 }
 
+@synthesize prefetchesSimulation = _prefetchesSimulation;
+@synthesize frameBudget = _frameBudget;
+@synthesize maximumDeferredFrames = _maximumDeferredFrames;
+
 + (id)sharedInstance {
     static XNAnimationLink *sharedAnimationLink = nil;
 
@@ -36,13 +136,76 @@
         [_displayLink addToRunLoop:[NSRunLoop currentRunLoop] forMode:NSRunLoopCommonModes];
 
         _activeAnimations = [[NSMutableDictionary alloc] init];
+        _extractor = [XNKeyValueExtractor sharedExtractor];
 
         _then = CACurrentMediaTime();
+
+        _prefetchesSimulation = ([[NSProcessInfo processInfo] activeProcessorCount] > 1);
+        _simulationQueue = dispatch_queue_create("com.xuzzproductions.animations.simulation", DISPATCH_QUEUE_SERIAL);
+
+        _frameBudget = kXNAnimationLinkDefaultFrameBudget;
+        _maximumDeferredFrames = kXNAnimationLinkDefaultMaximumDeferredFrames;
     }
 
     return self;
 }
 
+- (XNAnimationState *)acquireAnimationState {
+    if (_freeStates == NULL) {
+        XNAnimationState *block = calloc(kXNAnimationLinkStateBlockCount, sizeof(XNAnimationState));
+
+        for (NSUInteger i = 0; i < kXNAnimationLinkStateBlockCount; i++) {
+            block[i].restDistance = NAN;
+            block[i].restVelocity = NAN;
+            block[i].next = _freeStates;
+            _freeStates = &block[i];
+        }
+    }
+
+    XNAnimationState *state = _freeStates;
+    _freeStates = state->next;
+    state->next = NULL;
+
+    return state;
+}
+
+- (void)relinquishAnimationState:(XNAnimationState *)state {
+    [state->fromComponents release];
+    state->fromComponents = nil;
+    [state->toComponents release];
+    state->toComponents = nil;
+    [state->durations release];
+    state->durations = nil;
+    [state->velocities release];
+    state->velocities = nil;
+    state->restDistance = NAN;
+    state->restVelocity = NAN;
+    [state->timingFunction release];
+    state->timingFunction = nil;
+    state->timingFunctionMutations = 0;
+    state->target = nil;
+    state->elapsed = 0;
+    state->deferredTime = 0;
+    state->deferredFrames = 0;
+    state->finished = NO;
+
+    // Idle frames are kept to be reused, without this run's inputs. A frame
+    // still pending on the simulation queue is kept alive by that queue, so
+    // let it go rather than wait. The new generation makes any result from
+    // this run stale for the next one.
+    for (NSUInteger i = 0; i < sizeof(state->frames) / sizeof(state->frames[0]); i++) {
+        if (state->frames[i] != nil && ![state->frames[i] clear]) {
+            [state->frames[i] release];
+            state->frames[i] = nil;
+        }
+    }
+
+    state->generation += 1;
+
+    state->next = _freeStates;
+    _freeStates = state;
+}
+
 - (void)addAnimation:(XNAnimation *)animation toObject:(id)object {
     NSValue *value = [NSValue valueWithNonretainedObject:object];
 
@@ -102,19 +265,136 @@
     [animations release];
 }
 
-- (void)frameFromDisplayLink:(CADisplayLink *)displayLink {
-    NSTimeInterval now = CACurrentMediaTime();
-    NSTimeInterval frame = now - _then;
-    _then = now;
+- (void)simulateAnimations:(NSArray *)animations onObject:(id)object rootKey:(NSString *)rootKey timeInterval:(NSTimeInterval)dt {
+    id rootValue = [object valueForKey:rootKey];
 
-    NSMutableDictionary *completedAnimations = [NSMutableDictionary dictionary];
+    // Only structures can be patched; anything else is just set separately.
+    if (![rootValue isKindOfClass:[NSValue class]] || [rootValue isKindOfClass:[NSNumber class]]) {
+        for (XNAnimation *animation in animations) {
+            [animation simulateWithTimeInterval:dt];
+        }
+
+        return;
+    }
+
+    for (XNAnimation *animation in animations) {
+        // Could have been removed by a callback earlier in this frame.
+        if (![animation active]) {
+            continue;
+        }
+
+        id value = [animation valueBySimulatingWithTimeInterval:dt];
+        NSString *remainingKeyPath = XNAnimationLinkRemainingKeyPathForKeyPath([animation keyPath]);
+
+        rootValue = [_extractor value:rootValue replacingValue:value forKeyPath:remainingKeyPath];
+    }
+
+    [object setValue:rootValue forKey:rootKey];
+
+    for (XNAnimation *animation in animations) {
+        if ([animation active]) {
+            [animation didUpdate];
+        }
+    }
+}
+
+- (NSArray *)groupsForActiveAnimations {
+    NSMutableArray *groups = [NSMutableArray array];
 
     for (NSValue *value in _activeAnimations) {
         NSSet *animations = [_activeAnimations objectForKey:value];
-        
+        NSMutableDictionary *rootGroups = [NSMutableDictionary dictionary];
+
         for (XNAnimation *animation in animations) {
-            [animation simulateWithTimeInterval:frame];
+            NSString *rootKey = XNAnimationLinkRootKeyForKeyPath([animation keyPath]);
+            XNAnimationLinkGroup *group = [rootGroups objectForKey:rootKey];
+
+            if (group == nil) {
+                group = [[XNAnimationLinkGroup alloc] initWithObject:[value nonretainedObjectValue] rootKey:rootKey];
+                [rootGroups setObject:group forKey:rootKey];
+                [groups addObject:group];
+                [group release];
+            }
+
+            [group addAnimation:animation];
+        }
+    }
+
+    return groups;
+}
+
+- (void)prefetchFrameWithTimeInterval:(NSTimeInterval)dt {
+    NSMutableArray *frames = [NSMutableArray array];
+
+    for (NSValue *value in _activeAnimations) {
+        NSSet *animations = [_activeAnimations objectForKey:value];
+
+        for (XNAnimation *animation in animations) {
+            XNAnimationFrame *frame = [animation prefetchFrameWithTimeInterval:dt];
+
+            if (frame != nil) {
+                [frames addObject:frame];
+            }
+        }
+    }
+
+    if ([frames count] > 0) {
+        dispatch_async(_simulationQueue, ^{
+            for (XNAnimationFrame *frame in frames) {
+                [frame evaluate];
+            }
+        });
+    }
+}
+
+- (void)simulateFrameWithTimeInterval:(NSTimeInterval)frame {
+    NSTimeInterval start = CACurrentMediaTime();
+
+    // Grouped up front, so callbacks can add and remove animations while
+    // simulating without changing what's being iterated.
+    NSArray *groups = [self groupsForActiveAnimations];
+
+    // Groups go in order of their most urgent animation, so higher priorities
+    // get the budget if there isn't enough for everything. Each animation is
+    // still degraded by its own priority, but whatever is due in a group is set
+    // together.
+    for (XNAnimationPriority priority = XNAnimationPriorityInteractive; priority <= XNAnimationPriorityDecorative; priority++) {
+        for (XNAnimationLinkGroup *group in groups) {
+            if ([group priority] != priority) {
+                continue;
+            }
+
+            BOOL overloaded = (CACurrentMediaTime() - start > _frameBudget);
+            NSMutableArray *due = [NSMutableArray array];
 
+            for (XNAnimation *animation in [group animations]) {
+                XNAnimationPriority animationPriority = [animation priority];
+
+                if (![animation active]) {
+                    continue;
+                } else if (overloaded && animationPriority == XNAnimationPriorityStandard && [animation deferredFrames] < _maximumDeferredFrames) {
+                    [animation deferWithTimeInterval:frame];
+                } else if (overloaded && animationPriority == XNAnimationPriorityDecorative && ![animation completed]) {
+                    [animation finish];
+                } else {
+                    [due addObject:animation];
+                }
+            }
+
+            if ([due count] == 1) {
+                [[due lastObject] simulateWithTimeInterval:frame];
+            } else if ([due count] > 1) {
+                [self simulateAnimations:due onObject:[group object] rootKey:[group rootKey] timeInterval:frame];
+            }
+        }
+    }
+
+    NSMutableDictionary *completedAnimations = [NSMutableDictionary dictionary];
+
+    for (NSValue *value in _activeAnimations) {
+        NSSet *animations = [_activeAnimations objectForKey:value];
+
+        for (XNAnimation *animation in animations) {
             if ([animation completed] && [animation isRemovedOnCompletion]) {
                 if ([completedAnimations objectForKey:value] == nil) {
                     [completedAnimations setObject:[NSMutableSet set] forKey:value];
@@ -135,4 +415,21 @@
     }
 }
 
+- (void)frameFromDisplayLink:(CADisplayLink *)displayLink {
+    // Use the frame timestamp rather than the current time: it's steady from
+    // frame to frame, so prefetched frames line up with the real ones.
+    NSTimeInterval now = [displayLink timestamp];
+    NSTimeInterval frame = now - _then;
+    _then = now;
+
+    [[XNTraceRecorder activeRecorder] recordTickWithTimestamp:now];
+
+    [self simulateFrameWithTimeInterval:frame];
+
+    if (_prefetchesSimulation) {
+        NSTimeInterval expected = [displayLink duration] * [displayLink frameInterval];
+        [self prefetchFrameWithTimeInterval:expected];
+    }
+}
+
 @end
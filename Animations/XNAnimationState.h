@@ -0,0 +1,51 @@
+//
+//  XNAnimationState.h
+//  Animations
+//
+//  Created by Grant Paul on 1/19/13.
+//  Copyright (c) 2013 Xuzz Productions, LLC. All rights reserved.
+//
+
+// Private to XNAnimation and XNAnimationLink; not part of the public headers.
+
+@class XNTimingFunction;
+@class XNAnimationFrame;
+
+// Per-run state, only present while an animation is attached to an object.
+// Records are pooled by XNAnimationLink and reused once an animation ends.
+typedef struct XNAnimationState {
+    id target;
+    NSTimeInterval elapsed;
+
+    // Extracted from the configuration when the run starts, and again if it
+    // changes while running.
+    NSArray *fromComponents;
+    NSArray *toComponents;
+    NSArray *durations;
+    NSArray *velocities;
+    CGFloat restDistance; // NAN until extracted
+    CGFloat restVelocity;
+
+    // Copy of the timing function for the simulation queue, and the
+    // mutations of the original when it was copied.
+    XNTimingFunction *timingFunction;
+    NSUInteger timingFunctionMutations;
+
+    // Time skipped while the link was overloaded, added to the next step.
+    NSTimeInterval deferredTime;
+    NSUInteger deferredFrames;
+    BOOL finished; // jumped to the end
+
+    // Prefetching state. The generation changes whenever the parameters do,
+    // invalidating any frames computed from the old ones.
+    NSUInteger generation;
+    XNAnimationFrame *frames[2];
+
+    struct XNAnimationState *next; // free list
+} XNAnimationState;
+
+@interface XNAnimationFrame (Private)
+
+- (BOOL)clear; // releases the inputs and results, NO if still pending
+
+@end
@@ -8,11 +8,27 @@
 
 #import "XNBezierTimingFunction.h"
 
-const static NSInteger kXNBezierTimingFunctionNewtonsMethodIterations = 4;
+#import "XNCoreBezier.h"
+
+// Curves are sampled by the core (see XNCoreBezier.h). The sampled curves are
+// cached by control points and shared between all timing functions, as most
+// animations use one of a handful of standard curves. The cache is bounded,
+// so generated curves don't pile up; each timing function keeps its own curve
+// alive, so an eviction only means sampling again for the next one.
+static NSCache *XNBezierTimingFunctionCurveCache = nil;
+const static NSUInteger kXNBezierTimingFunctionCurveCacheCount = 64;
 
 @implementation XNBezierTimingFunction {
     NSArray *_controlPoints;
-    NSArray *_completeControlPoints;
+
+    NSData *_curve;
+}
+
++ (void)initialize {
+    if (self == [XNBezierTimingFunction class]) {
+        XNBezierTimingFunctionCurveCache = [[NSCache alloc] init];
+        [XNBezierTimingFunctionCurveCache setCountLimit:kXNBezierTimingFunctionCurveCacheCount];
+    }
 }
 
 @synthesize controlPoints = _controlPoints;
@@ -21,15 +37,10 @@ const static NSInteger kXNBezierTimingFunctionNewtonsMethodIterations = 4;
     [_controlPoints release];
     _controlPoints = [controlPoints copy];
 
-    NSValue *start = [NSValue valueWithCGPoint:CGPointMake(0, 0)];
-    NSValue *end = [NSValue valueWithCGPoint:CGPointMake(1.0, 1.0)];
+    [_curve release];
+    _curve = [[self curveForControlPoints:_controlPoints] retain];
 
-    NSMutableArray *points = [NSMutableArray arrayWithObject:start];
-    [points addObjectsFromArray:_controlPoints];
-    [points addObject:end];
-
-    [_completeControlPoints release];
-    _completeControlPoints = [points copy];
+    [self didChange];
 }
 
 + (NSArray *)controlPointsEaseIn {
@@ -77,75 +88,40 @@ const static NSInteger kXNBezierTimingFunctionNewtonsMethodIterations = 4;
 }
 
 - (void)dealloc {
-    [_completeControlPoints release];
+    [_curve release];
     [_controlPoints release];
 
     [super dealloc];
 }
 
-// Not sure how this works, but it does. Found online somewhere.
-#define nCr(n, r) round(exp((lgamma(n+1)) - (lgamma(r+1) + lgamma(n-r+1))))
-
-- (CGPoint)bezierDerivativeAtTime:(CGFloat)t {
-    CGPoint result = CGPointZero;
-
-    NSUInteger n = [_completeControlPoints count] - 1;
-
-    for (NSUInteger i = 0; i <= (n - 1); i++) {
-        NSValue *pointValue = [_completeControlPoints objectAtIndex:i];
-        CGPoint point = [pointValue CGPointValue];
-
-        NSValue *nextPointValue = [_completeControlPoints objectAtIndex:(i + 1)];
-        CGPoint nextPoint = [nextPointValue CGPointValue];
+- (NSData *)curveForControlPoints:(NSArray *)controlPoints {
+    // NSCache is thread safe; two threads missing at once just both sample.
+    NSData *curve = [XNBezierTimingFunctionCurveCache objectForKey:controlPoints];
 
-        CGFloat b = nCr((n - 1), i) * powf(t, i) * powf(1 - t, (n - 1) - i);
-        result.x += n * (nextPoint.x - point.x) * b;
-        result.y += n * (nextPoint.y - point.y) * b;
-    }
-
-    return result;
-}
+    if (curve == nil) {
+        NSUInteger count = [controlPoints count];
+        double points[count * 2];
 
-- (CGPoint)bezierAtTime:(CGFloat)t {
-    CGPoint result = CGPointZero;
+        for (NSUInteger i = 0; i < count; i++) {
+            CGPoint point = [[controlPoints objectAtIndex:i] CGPointValue];
+            points[i * 2 + 0] = point.x;
+            points[i * 2 + 1] = point.y;
+        }
 
-    NSUInteger n = [_completeControlPoints count] - 1;
+        NSMutableData *samples = [NSMutableData dataWithLength:sizeof(XNCoreBezierCurve)];
+        XNCoreBezierCurveInit([samples mutableBytes], points, count);
 
-    for (NSUInteger i = 0; i <= n; i++) {
-        NSValue *pointValue = [_completeControlPoints objectAtIndex:i];
-        CGPoint point = [pointValue CGPointValue];
-
-        CGFloat b = nCr(n, i) * powf(t, i) * powf(1 - t, n - i);
-        result.x += point.x * b;
-        result.y += point.y * b;
+        curve = [[samples copy] autorelease];
+        [XNBezierTimingFunctionCurveCache setObject:curve forKey:controlPoints];
     }
 
-    return result;
+    return curve;
 }
 
-- (CGFloat)simulateIndex:(NSUInteger)i elapsed:(NSTimeInterval)elapsed duration:(CGFloat)duration complete:(BOOL *)outComplete {
-    [super simulateIndex:i elapsed:elapsed duration:duration complete:outComplete];
-
-    CGPoint result = CGPointZero;
-    CGFloat t = (elapsed / duration);
-    
-    CGFloat a = t;
-    for (NSInteger i = 0; i < kXNBezierTimingFunctionNewtonsMethodIterations; i++) {
-        result = [self bezierAtTime:a];
-        CGPoint deriv = [self bezierDerivativeAtTime:a];
-
-        a = a - ((result.x - t) / deriv.x);
-    }
-
-    CGFloat x = result.y;
-
-    if (t >= 1.0) {
-        *outComplete = YES;
-        return 1.0;
-    } else {
-        *outComplete = NO;
-        return x;
-    }
+- (void)simulateCount:(NSUInteger)count elapsed:(NSTimeInterval)elapsed durations:(const double *)durations fromComponents:(const double *)from toComponents:(const double *)to positions:(double *)positions complete:(BOOL *)outComplete {
+    bool complete = false;
+    XNCoreBezierCurveEvaluateBatch([_curve bytes], count, elapsed, durations, from, to, positions, &complete);
+    *outComplete = complete;
 }
 
 @end
@@ -12,6 +12,9 @@
 
 @property (nonatomic, assign) CGFloat constant;
 @property (nonatomic, assign) CGFloat bounce;
+// Kept for compatibility, but no longer affects the simulation: the animation
+// stops by XNAnimation's restDistance and restVelocity. Where a decay ends is
+// up to the sensitivity passed to +toValueFromValue:...sensitivity:.
 @property (nonatomic, assign) CGFloat sensitivity;
 
 @property (nonatomic, retain) id insideValue;
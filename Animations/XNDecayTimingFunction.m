@@ -9,7 +9,7 @@
 #import "XNKeyValueExtractor.h"
 #import "XNDecayTimingFunction.h"
 
-const static CGFloat kXNDecayTimingFunctionTemporalSensitivity = 1000.0f;
+#import "XNCoreDecay.h"
 
 const static CGFloat kXNDecayTimingFunctionDefaultConstant = 0.998f;
 const static CGFloat kXNDecayTimingFunctionDefaultBounce = 0.99f;
@@ -29,57 +29,31 @@ const static CGFloat kXNDecayTimingFunctionDefaultSensitivity = 0.001f;
 @synthesize constant = _constant;
 @synthesize bounce = _bounce;
 
-// The basic scroll view algorithm, each frame:
-//
-// v = v * c                 -- constant friciton
-// x = x + v                 -- v = dx/dt
-// if outside:
-//   x = x - d * (1 - b)     -- the magic: move back
-//   v = v * b               -- slow down faster
-//
-// d: distance outside scroll view
-// c: scrolling constant; 0.998
-// b: bounce constant; 0.99
-//
-// Apple implements this strangely. Rather than taking an integral of the above,
-// they use a summation over every millisecond. To reproduce the same behavior
-// and to allow for use of identical scrolling and bounce coefficients, the same
-// strange features are emulated here, with the millisecond conversion factor
-// stored in kXNDecayTimingFunctionTemporalSensitivity and the simplification of
-// the summation present in the following functions.
-
-static CGFloat XNDecayTimingFunctionSimpleVelocityAtTime(CGFloat c, CGFloat t, CGFloat v0) {
-    return powf(c, t) * v0;
-}
+- (void)setInsideValue:(id)insideValue {
+    [insideValue retain];
+    [_insideComponents release];
+    _insideComponents = insideValue;
 
-static CGFloat XNDecayTimingFunctionSimpleDistanceAtTime(CGFloat c, CGFloat t, CGFloat v0, CGFloat x0) {
-    return x0 + c * v0 * (1 - powf(c, t)) / (1 - c);
+    [self didChange];
 }
 
-static CGFloat XNDecayTimingFunctionBouncingVelocityAtTime(CGFloat c, CGFloat b, CGFloat t, CGFloat v0) {
-    return powf(b * c, t) * v0;
+- (void)setSensitivity:(CGFloat)sensitivity {
+    _sensitivity = sensitivity;
+    [self didChange];
 }
 
-static CGFloat XNDecayTimingFunctionBouncingDistanceAtTime(CGFloat c, CGFloat b, CGFloat t, CGFloat v0, CGFloat x0, CGFloat xF) {
-    return powf(b, t) * x0 + c * powf(b, t) * v0 * (1 - powf(c, t)) / (1 - c) + xF * (1 - powf(b, t));
+- (void)setConstant:(CGFloat)constant {
+    _constant = constant;
+    [self didChange];
 }
 
-+ (CGFloat)toFrom:(CGFloat)from velocity:(CGFloat)velocity constant:(CGFloat)constant sensitivity:(CGFloat)sensitivity {
-    if (velocity == 0) {
-        return from;
-    }
-
-    CGFloat v0 = velocity / kXNDecayTimingFunctionTemporalSensitivity;
-
-    // Solve for time when velocity = sensitivity.
-    CGFloat t = logf(sensitivity / fabs(v0)) / logf(constant);
-    CGFloat x = XNDecayTimingFunctionSimpleDistanceAtTime(constant, t, v0, from);
-
-    return x;
+- (void)setBounce:(CGFloat)bounce {
+    _bounce = bounce;
+    [self didChange];
 }
 
 + (id)toValueFromValue:(id)from forVelocity:(id)velocity withConstant:(CGFloat)constant sensitivity:(CGFloat)sensitivity {
-    XNKeyValueExtractor *kve = [[XNKeyValueExtractor alloc] init];
+    XNKeyValueExtractor *kve = [XNKeyValueExtractor sharedExtractor];
 
     NSArray *velocityComponents = [kve componentsForObject:velocity];
     NSArray *fromComponents = [kve componentsForObject:from];
@@ -87,22 +61,17 @@ static CGFloat XNDecayTimingFunctionBouncingDistanceAtTime(CGFloat c, CGFloat b,
     NSMutableArray *toComponents = [NSMutableArray array];
 
     for (NSInteger i = 0; i < [fromComponents count]; i++) {
-        NSNumber *velocityValue = [velocityComponents objectAtIndex:i];
-        NSNumber *fromValue = [fromComponents objectAtIndex:i];
+        double v = [[velocityComponents objectAtIndex:i] doubleValue];
+        double f = [[fromComponents objectAtIndex:i] doubleValue];
 
-        CGFloat v = [velocityValue floatValue];
-        CGFloat f = [fromValue floatValue];
-        
-        CGFloat to = [self toFrom:f velocity:v constant:constant sensitivity:sensitivity];
-        NSNumber *toValue = [NSNumber numberWithFloat:to];
+        double to = XNCoreDecayDistance(constant, f, v, sensitivity);
+        NSNumber *toValue = [NSNumber numberWithDouble:to];
 
         [toComponents addObject:toValue];
     }
 
     id to = [kve objectFromComponents:toComponents templateObject:velocity];
 
-    [kve release];
-
     return to;
 }
 
@@ -111,25 +80,21 @@ static CGFloat XNDecayTimingFunctionBouncingDistanceAtTime(CGFloat c, CGFloat b,
 }
 
 + (id)insideValueFromValue:(id)fromValue toValue:(id)toValue minimumValue:(id)minimumValue maximumValue:(id)maximumValue {
-    XNKeyValueExtractor *kve = [[XNKeyValueExtractor alloc] init];
+    XNKeyValueExtractor *kve = [XNKeyValueExtractor sharedExtractor];
     NSArray *minimumComponents = [kve componentsForObject:minimumValue];
     NSArray *maximumComponents = [kve componentsForObject:maximumValue];
     NSArray *fromComponents = [kve componentsForObject:fromValue];
     NSArray *toComponents = [kve componentsForObject:toValue];
-    [kve release];
 
     NSMutableArray *betweenComponents = [NSMutableArray array];
 
     for (NSUInteger i = 0; i < [fromComponents count]; i++) {
-        CGFloat min = [[minimumComponents objectAtIndex:i] floatValue];
-        CGFloat max = [[maximumComponents objectAtIndex:i] floatValue];
-        CGFloat from = [[fromComponents objectAtIndex:i] floatValue];
-        CGFloat to = [[toComponents objectAtIndex:i] floatValue];
-
-        BOOL leftOutside = (from <= min && to <= min);
-        BOOL rightOutside = (from >= max && to >= max);
+        double min = [[minimumComponents objectAtIndex:i] doubleValue];
+        double max = [[maximumComponents objectAtIndex:i] doubleValue];
+        double from = [[fromComponents objectAtIndex:i] doubleValue];
+        double to = [[toComponents objectAtIndex:i] doubleValue];
 
-        NSValue *betweenValue = [NSNumber numberWithBool:(!rightOutside && !leftOutside)];
+        NSValue *betweenValue = [NSNumber numberWithBool:XNCoreDecayInside(from, to, min, max)];
         [betweenComponents addObject:betweenValue];
     }
 
@@ -160,6 +125,8 @@ static CGFloat XNDecayTimingFunctionBouncingDistanceAtTime(CGFloat c, CGFloat b,
     id copy = [super copyWithZone:zone];
     [copy setSensitivity:[self sensitivity]];
     [copy setConstant:[self constant]];
+    [copy setBounce:[self bounce]];
+    [copy setInsideValue:[self insideValue]];
     return copy;
 }
 
@@ -173,62 +140,25 @@ static CGFloat XNDecayTimingFunctionBouncingDistanceAtTime(CGFloat c, CGFloat b,
     return self;
 }
 
-- (CGFloat)simulateIndex:(NSUInteger)i elapsed:(NSTimeInterval)elapsed velocity:(CGFloat)velocity complete:(BOOL *)outComplete {
-    [super simulateIndex:i elapsed:elapsed velocity:velocity complete:outComplete];
+- (void)dealloc {
+    [_insideComponents release];
 
-    CGFloat c = _constant;
-    CGFloat b = _bounce;
-    
-    CGFloat v0 = velocity / kXNDecayTimingFunctionTemporalSensitivity;
-    CGFloat t = elapsed * kXNDecayTimingFunctionTemporalSensitivity;
-
-    NSNumber *insideValue = [_insideComponents objectAtIndex:i];
-    BOOL outside = ![insideValue boolValue];
-
-    CGFloat tSwitch = 0;
-    CGFloat xSwitch = 0;
-
-    if (outside) {
-        tSwitch = 0;
-        xSwitch = 0;
-    } else {
-        // Solve for time when distance equals 1.0.
-        // c * v0 * (1 - powf(c, t)) / (1 - c) = 1.0
-        // 1.0 / (c * v0) = (1 - powf(c, t)) / (1 - c)
-        // (1 - c) / (c * v0) = 1 - powf(c, t)
-        // -((1 - c) / (c * v0) - 1) = powf(c, t)
-        // t = logf(-((1 - c) / (c * fabs(v0)) - 1)) / logf(c)
-        tSwitch = logf(-((1 - c) / (c * fabs(v0)) - 1)) / logf(c);
-
-        if (isnan(tSwitch)) {
-            // Is this the right thing to do here?
-            tSwitch = CGFLOAT_MAX;
-        }
-        
-        xSwitch = XNDecayTimingFunctionSimpleDistanceAtTime(c, tSwitch, v0, 0.0);
-    }
+    [super dealloc];
+}
 
-    CGFloat v = 0;
-    CGFloat x = 0;
-
-    if (t < tSwitch) {
-        v = XNDecayTimingFunctionSimpleVelocityAtTime(c, t, v0);
-        x = XNDecayTimingFunctionSimpleDistanceAtTime(c, t, v0, 0.0);
-    } else {
-        CGFloat vSwitch = XNDecayTimingFunctionSimpleVelocityAtTime(c, tSwitch, v0);
-        CGFloat tAfterSwitch = t - tSwitch;
-        
-        v = XNDecayTimingFunctionBouncingVelocityAtTime(c, b, tAfterSwitch, vSwitch);
-        x = XNDecayTimingFunctionBouncingDistanceAtTime(c, b, tAfterSwitch, vSwitch, xSwitch, 1.0);
-    }
+- (void)simulateCount:(NSUInteger)count elapsed:(NSTimeInterval)elapsed velocities:(const double *)velocities fromComponents:(const double *)from toComponents:(const double *)to restDistance:(CGFloat)restDistance restVelocity:(CGFloat)restVelocity positions:(double *)positions complete:(BOOL *)outComplete {
+    XNCoreDecay decay = { _constant, _bounce };
 
-    if (fabs(v) <= _sensitivity && fabs(x - 1.0) < _sensitivity) {
-        *outComplete = YES;
-        return 1.0;
-    } else {
-        *outComplete = NO;
-        return x;
+    bool inside[count];
+
+    for (NSUInteger i = 0; i < count; i++) {
+        NSNumber *insideValue = [_insideComponents objectAtIndex:i];
+        inside[i] = [insideValue boolValue];
     }
+
+    bool complete = false;
+    XNCoreDecayEvaluateBatch(&decay, inside, count, elapsed, velocities, from, to, restDistance, restVelocity, positions, &complete);
+    *outComplete = complete;
 }
 
 @end
@@ -10,8 +10,11 @@
 
 @interface XNKeyValueExtractor : NSObject
 
++ (XNKeyValueExtractor *)sharedExtractor; // main thread only
+
 - (id)object:(id)object valueForKeyPath:(NSString *)keyPath;
 - (void)object:(id)object setValue:(id)value forKeyPath:(NSString *)keyPath;
+- (id)value:(id)value replacingValue:(id)replacement forKeyPath:(NSString *)keyPath; // key path is relative to the structure
 - (NSArray *)componentsForObject:(id)object;
 - (id)objectFromComponents:(NSArray *)components templateObject:(id)object;
 
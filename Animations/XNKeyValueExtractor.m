@@ -10,16 +10,30 @@
 
 #import "XNKeyValueExtractor.h"
 
+#import "XNCoreComponents.h"
+
 @implementation XNKeyValueExtractor {
     CALayer *_hackLayer;
 }
 
-- (id)init {
-    if ((self = [super init])) {
++ (XNKeyValueExtractor *)sharedExtractor {
+    static XNKeyValueExtractor *sharedExtractor = nil;
+
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedExtractor = [[XNKeyValueExtractor alloc] init];
+    });
+
+    return sharedExtractor;
+}
+
+// Only transforms need the layer, so don't pay for one until then.
+- (CALayer *)hackLayer {
+    if (_hackLayer == nil) {
         _hackLayer = [[CALayer alloc] init];
     }
 
-    return self;
+    return _hackLayer;
 }
 
 - (void)dealloc {
@@ -81,95 +95,95 @@
                     }
                 } else if ([type isEqualToString:@"{CGAffineTransform=ffffff}"]) {
                     CGAffineTransform transform = [value CGAffineTransformValue];
-                    [_hackLayer setAffineTransform:transform];
+                    [[self hackLayer] setAffineTransform:transform];
 
                     if ([key isEqualToString:@"rotation"]) {
-                        value = [_hackLayer valueForKeyPath:@"transform.rotation"];
+                        value = [[self hackLayer] valueForKeyPath:@"transform.rotation"];
                     } else if ([key isEqualToString:@"scale"]) {
                         if (nextKey != nil) {
                             if ([nextKey isEqualToString:@"x"]) {
                                 i += 1;
-                                value = [_hackLayer valueForKeyPath:@"transform.scale.x"];
+                                value = [[self hackLayer] valueForKeyPath:@"transform.scale.x"];
                             } else if ([nextKey isEqualToString:@"y"]) {
                                 i += 1;
-                                value = [_hackLayer valueForKeyPath:@"transform.scale.y"];
+                                value = [[self hackLayer] valueForKeyPath:@"transform.scale.y"];
                             } else {
                                 [e raise];
                             }
                         } else {
-                            value = [_hackLayer valueForKeyPath:@"transform.scale"];
+                            value = [[self hackLayer] valueForKeyPath:@"transform.scale"];
                         }
                     } else if ([key isEqualToString:@"translation"]) {
                         if (nextKey != nil) {
                             if ([nextKey isEqualToString:@"x"]) {
                                 i += 1;
-                                value = [_hackLayer valueForKeyPath:@"transform.translation.x"];
+                                value = [[self hackLayer] valueForKeyPath:@"transform.translation.x"];
                             } else if ([nextKey isEqualToString:@"y"]) {
                                 i += 1;
-                                value = [_hackLayer valueForKeyPath:@"transform.translation.y"];
+                                value = [[self hackLayer] valueForKeyPath:@"transform.translation.y"];
                             } else {
                                 [e raise];
                             }
                         } else {
-                            value = [_hackLayer valueForKeyPath:@"transform.translation"];
+                            value = [[self hackLayer] valueForKeyPath:@"transform.translation"];
                         }
                     } else {
                         [e raise];
                     }
                 } else if ([type isEqualToString:@"{CATransform3D=ffffffffffffffff}"]) {
                     CATransform3D transform = [value CATransform3DValue];
-                    [_hackLayer setTransform:transform];
+                    [[self hackLayer] setTransform:transform];
 
                     if ([key isEqualToString:@"rotation"]) {
                         if (nextKey != nil) {
                             if ([nextKey isEqualToString:@"x"]) {
                                 i += 1;
-                                value = [_hackLayer valueForKeyPath:@"transform.rotation.x"];
+                                value = [[self hackLayer] valueForKeyPath:@"transform.rotation.x"];
                             } else if ([nextKey isEqualToString:@"y"]) {
                                 i += 1;
-                                value = [_hackLayer valueForKeyPath:@"transform.rotation.y"];
+                                value = [[self hackLayer] valueForKeyPath:@"transform.rotation.y"];
                             } else if ([nextKey isEqualToString:@"z"]) {
                                 i += 1;
-                                value = [_hackLayer valueForKeyPath:@"transform.rotation.z"];
+                                value = [[self hackLayer] valueForKeyPath:@"transform.rotation.z"];
                             } else {
                                 [e raise];
                             }
                         } else {
-                            value = [_hackLayer valueForKeyPath:@"transform.rotation"];
+                            value = [[self hackLayer] valueForKeyPath:@"transform.rotation"];
                         }
                     } else if ([key isEqualToString:@"scale"]) {
                         if (nextKey != nil) {
                             if ([nextKey isEqualToString:@"x"]) {
                                 i += 1;
-                                value = [_hackLayer valueForKeyPath:@"transform.scale.x"];
+                                value = [[self hackLayer] valueForKeyPath:@"transform.scale.x"];
                             } else if ([nextKey isEqualToString:@"y"]) {
                                 i += 1;
-                                value = [_hackLayer valueForKeyPath:@"transform.scale.y"];
+                                value = [[self hackLayer] valueForKeyPath:@"transform.scale.y"];
                             } else if ([nextKey isEqualToString:@"z"]) {
                                 i += 1;
-                                value = [_hackLayer valueForKeyPath:@"transform.scale.z"];
+                                value = [[self hackLayer] valueForKeyPath:@"transform.scale.z"];
                             } else {
                                 [e raise];
                             }
                         } else {
-                            value = [_hackLayer valueForKeyPath:@"transform.scale"];
+                            value = [[self hackLayer] valueForKeyPath:@"transform.scale"];
                         }
                     } else if ([key isEqualToString:@"translation"]) {
                         if (nextKey != nil) {
                             if ([nextKey isEqualToString:@"x"]) {
                                 i += 1;
-                                value = [_hackLayer valueForKeyPath:@"transform.translation.x"];
+                                value = [[self hackLayer] valueForKeyPath:@"transform.translation.x"];
                             } else if ([nextKey isEqualToString:@"y"]) {
                                 i += 1;
-                                value = [_hackLayer valueForKeyPath:@"transform.translation.y"];
+                                value = [[self hackLayer] valueForKeyPath:@"transform.translation.y"];
                             } else if ([nextKey isEqualToString:@"z"]) {
                                 i += 1;
-                                value = [_hackLayer valueForKeyPath:@"transform.translation.z"];
+                                value = [[self hackLayer] valueForKeyPath:@"transform.translation.z"];
                             } else {
                                 [e raise];
                             }
                         } else {
-                            value = [_hackLayer valueForKeyPath:@"transform.translation"];
+                            value = [[self hackLayer] valueForKeyPath:@"transform.translation"];
                         }
                     } else {
                         [e raise];
@@ -230,158 +244,176 @@
     if ([remainingComponents count] == 1) {
         [value setValue:v forKey:initialRemainingKey];
     } else {
-        NSException *e = exception;
         id current = [value valueForKey:initialRemainingKey];
 
         if ([current isKindOfClass:[NSValue class]]) {
-            NSString *type = [NSString stringWithUTF8String:[current objCType]];
+            NSArray *structComponents = [remainingComponents subarrayWithRange:NSMakeRange(1, [remainingComponents count] - 1)];
+            NSString *structKeyPath = [structComponents componentsJoinedByString:@"."];
 
-            NSString *key = ([remainingComponents count] > 1) ? [remainingComponents objectAtIndex:1] : nil;
-            NSString *nextKey = ([remainingComponents count] > 2) ? [remainingComponents objectAtIndex:2] : nil;
+            id updated = [self value:current replacingValue:v forKeyPath:structKeyPath];
+            [value setValue:updated forKey:initialRemainingKey];
+        } else {
+            [exception raise];
+        }
+    }
+}
 
-            if ([type isEqualToString:@"{CGPoint=ff}"] || [type isEqualToString:@"{NSPoint=ff}"]) {
-                CGPoint point = [current CGPointValue];
+- (id)value:(id)current replacingValue:(id)v forKeyPath:(NSString *)keyPath {
+    if ([[keyPath stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]] length] == 0) {
+        return v;
+    }
 
-                if ([key isEqualToString:@"x"]) {
-                    point.x = [v floatValue];
-                } else if ([key isEqualToString:@"y"]) {
-                    point.y = [v floatValue];
-                } else {
-                    [e raise];
-                }
+    if (![current isKindOfClass:[NSValue class]]) {
+        [NSException raise:@"XNKeyValueExtractorInvalidKeyPathException" format:@"key path %@ is not valid for %@", keyPath, current];
+    }
 
-                [value setValue:[NSValue valueWithCGPoint:point] forKey:initialRemainingKey];
-            } else if ([type isEqualToString:@"{CGSize=ff}"] || [type isEqualToString:@"{NSSize=ff}"]) {
-                CGSize size = [current CGSizeValue];
+    NSString *type = [NSString stringWithUTF8String:[current objCType]];
 
-                if ([key isEqualToString:@"width"]) {
-                    size.width = [v floatValue];
-                } else if ([key isEqualToString:@"height"]) {
-                    size.height = [v floatValue];
-                } else {
-                    [e raise];
-                }
+    NSArray *components = [keyPath componentsSeparatedByString:@"."];
+    NSString *key = [components objectAtIndex:0];
+    NSString *nextKey = ([components count] > 1) ? [components objectAtIndex:1] : nil;
 
-                [value setValue:[NSValue valueWithCGSize:size] forKey:initialRemainingKey];
-            } else if ([type isEqualToString:@"{CGRect={CGPoint=ff}{CGSize=ff}}"] || [type isEqualToString:@"{NSRect={NSPoint=ff}{NSSize=ff}}"]) {
-                CGRect rect = [current CGRectValue];
+    if ([type isEqualToString:@"{CGPoint=ff}"] || [type isEqualToString:@"{NSPoint=ff}"]) {
+        CGPoint point = [current CGPointValue];
 
-                if ([key isEqualToString:@"origin"]) {
-                    if ([nextKey isEqualToString:@"x"]) {
-                        rect.origin.x = [v floatValue];
-                    } else if ([nextKey isEqualToString:@"y"]) {
-                        rect.origin.y = [v floatValue];
-                    } else {
-                        rect.origin= [v CGPointValue];
-                    }
-                } else if ([key isEqualToString:@"size"]) {
-                    if ([nextKey isEqualToString:@"width"]) {
-                        rect.size.width = [v floatValue];
-                    } else if ([nextKey isEqualToString:@"height"]) {
-                        rect.size.height = [v floatValue];
-                    } else {
-                        rect.size = [v CGSizeValue];
-                    }
+        if ([key isEqualToString:@"x"]) {
+            point.x = [v floatValue];
+        } else if ([key isEqualToString:@"y"]) {
+            point.y = [v floatValue];
+        } else {
+            [NSException raise:@"XNKeyValueExtractorInvalidKeyPathException" format:@"key path %@ is not valid for %@", keyPath, current];
+        }
+
+        return [NSValue valueWithCGPoint:point];
+    } else if ([type isEqualToString:@"{CGSize=ff}"] || [type isEqualToString:@"{NSSize=ff}"]) {
+        CGSize size = [current CGSizeValue];
+
+        if ([key isEqualToString:@"width"]) {
+            size.width = [v floatValue];
+        } else if ([key isEqualToString:@"height"]) {
+            size.height = [v floatValue];
+        } else {
+            [NSException raise:@"XNKeyValueExtractorInvalidKeyPathException" format:@"key path %@ is not valid for %@", keyPath, current];
+        }
+
+        return [NSValue valueWithCGSize:size];
+    } else if ([type isEqualToString:@"{CGRect={CGPoint=ff}{CGSize=ff}}"] || [type isEqualToString:@"{NSRect={NSPoint=ff}{NSSize=ff}}"]) {
+        CGRect rect = [current CGRectValue];
+
+        if ([key isEqualToString:@"origin"]) {
+            if ([nextKey isEqualToString:@"x"]) {
+                rect.origin.x = [v floatValue];
+            } else if ([nextKey isEqualToString:@"y"]) {
+                rect.origin.y = [v floatValue];
+            } else {
+                rect.origin= [v CGPointValue];
+            }
+        } else if ([key isEqualToString:@"size"]) {
+            if ([nextKey isEqualToString:@"width"]) {
+                rect.size.width = [v floatValue];
+            } else if ([nextKey isEqualToString:@"height"]) {
+                rect.size.height = [v floatValue];
+            } else {
+                rect.size = [v CGSizeValue];
+            }
+        } else {
+            [NSException raise:@"XNKeyValueExtractorInvalidKeyPathException" format:@"key path %@ is not valid for %@", keyPath, current];
+        }
+
+        return [NSValue valueWithCGRect:rect];
+    } else if ([type isEqualToString:@"{CGAffineTransform=ffffff}"]) {
+        CGAffineTransform transform = [current CGAffineTransformValue];
+        [[self hackLayer] setAffineTransform:transform];
+
+        if ([key isEqualToString:@"rotation"]) {
+            [[self hackLayer] setValue:v forKeyPath:@"transform.rotation"];
+        } else if ([key isEqualToString:@"scale"]) {
+            if (nextKey != nil) {
+                if ([nextKey isEqualToString:@"x"]) {
+                    [[self hackLayer] setValue:v forKeyPath:@"transform.scale.x"];
+                } else if ([nextKey isEqualToString:@"y"]) {
+                    [[self hackLayer] setValue:v forKeyPath:@"transform.scale.y"];
                 } else {
-                    [e raise];
+                    [NSException raise:@"XNKeyValueExtractorInvalidKeyPathException" format:@"key path %@ is not valid for %@", keyPath, current];
                 }
-
-                [value setValue:[NSValue valueWithCGRect:rect] forKey:initialRemainingKey];
-            } else if ([type isEqualToString:@"{CGAffineTransform=ffffff}"]) {
-                CGAffineTransform transform = [current CGAffineTransformValue];
-                [_hackLayer setAffineTransform:transform];
-
-                if ([key isEqualToString:@"rotation"]) {
-                    [_hackLayer setValue:v forKeyPath:@"transform.rotation"];
-                } else if ([key isEqualToString:@"scale"]) {
-                    if (nextKey != nil) {
-                        if ([nextKey isEqualToString:@"x"]) {
-                            [_hackLayer setValue:v forKeyPath:@"transform.scale.x"];
-                        } else if ([nextKey isEqualToString:@"y"]) {
-                            [_hackLayer setValue:v forKeyPath:@"transform.scale.y"];
-                        } else {
-                            [e raise];
-                        }
-                    } else {
-                        [_hackLayer setValue:v forKeyPath:@"transform.scale"];
-                    }
-                } else if ([key isEqualToString:@"translation"]) {
-                    if (nextKey != nil) {
-                        if ([nextKey isEqualToString:@"x"]) {
-                            [_hackLayer setValue:v forKeyPath:@"transform.translation.x"];
-                        } else if ([nextKey isEqualToString:@"y"]) {
-                            [_hackLayer setValue:v forKeyPath:@"transform.translation.y"];
-                        } else {
-                            [e raise];
-                        }
-                    } else {
-                        [_hackLayer setValue:v forKeyPath:@"transform.translation"];
-                    }
+            } else {
+                [[self hackLayer] setValue:v forKeyPath:@"transform.scale"];
+            }
+        } else if ([key isEqualToString:@"translation"]) {
+            if (nextKey != nil) {
+                if ([nextKey isEqualToString:@"x"]) {
+                    [[self hackLayer] setValue:v forKeyPath:@"transform.translation.x"];
+                } else if ([nextKey isEqualToString:@"y"]) {
+                    [[self hackLayer] setValue:v forKeyPath:@"transform.translation.y"];
                 } else {
-                    [e raise];
+                    [NSException raise:@"XNKeyValueExtractorInvalidKeyPathException" format:@"key path %@ is not valid for %@", keyPath, current];
                 }
+            } else {
+                [[self hackLayer] setValue:v forKeyPath:@"transform.translation"];
+            }
+        } else {
+            [NSException raise:@"XNKeyValueExtractorInvalidKeyPathException" format:@"key path %@ is not valid for %@", keyPath, current];
+        }
 
-                transform = CATransform3DGetAffineTransform([_hackLayer transform]);
-                [value setValue:[NSValue valueWithCGAffineTransform:transform] forKey:initialRemainingKey];
-            } else if ([type isEqualToString:@"{CATransform3D=ffffffffffffffff}"]) {
-                CATransform3D transform = [current CATransform3DValue];
-                [_hackLayer setTransform:transform];
-
-                if ([key isEqualToString:@"rotation"]) {
-                    if (nextKey != nil) {
-                        if ([nextKey isEqualToString:@"x"]) {
-                            [_hackLayer setValue:v forKeyPath:@"transform.rotation.x"];
-                        } else if ([nextKey isEqualToString:@"y"]) {
-                            [_hackLayer setValue:v forKeyPath:@"transform.rotation.y"];
-                        } else if ([nextKey isEqualToString:@"z"]) {
-                            [_hackLayer setValue:v forKeyPath:@"transform.rotation.z"];
-                        } else {
-                            [e raise];
-                        }
-                    } else {
-                        [_hackLayer setValue:v forKeyPath:@"transform.rotation"];
-                    }
-                } else if ([key isEqualToString:@"scale"]) {
-                    if (nextKey != nil) {
-                        if ([nextKey isEqualToString:@"x"]) {
-                            [_hackLayer setValue:v forKeyPath:@"transform.scale.x"];
-                        } else if ([nextKey isEqualToString:@"y"]) {
-                            [_hackLayer setValue:v forKeyPath:@"transform.scale.y"];
-                        } else if ([nextKey isEqualToString:@"z"]) {
-                            [_hackLayer setValue:v forKeyPath:@"transform.scale.z"];
-                        } else {
-                            [e raise];
-                        }
-                    } else {
-                        [_hackLayer setValue:v forKeyPath:@"transform.scale"];
-                    }
-                } else if ([key isEqualToString:@"translation"]) {
-                    if (nextKey != nil) {
-                        if ([nextKey isEqualToString:@"x"]) {
-                            [_hackLayer setValue:v forKeyPath:@"transform.translation.x"];
-                        } else if ([nextKey isEqualToString:@"y"]) {
-                            [_hackLayer setValue:v forKeyPath:@"transform.translation.y"];
-                        } else if ([nextKey isEqualToString:@"z"]) {
-                            [_hackLayer setValue:v forKeyPath:@"transform.translation.z"];
-                        } else {
-                            [e raise];
-                        }
-                    } else {
-                        [_hackLayer setValue:v forKeyPath:@"transform.translation"];
-                    }
+        transform = CATransform3DGetAffineTransform([[self hackLayer] transform]);
+        return [NSValue valueWithCGAffineTransform:transform];
+    } else if ([type isEqualToString:@"{CATransform3D=ffffffffffffffff}"]) {
+        CATransform3D transform = [current CATransform3DValue];
+        [[self hackLayer] setTransform:transform];
+
+        if ([key isEqualToString:@"rotation"]) {
+            if (nextKey != nil) {
+                if ([nextKey isEqualToString:@"x"]) {
+                    [[self hackLayer] setValue:v forKeyPath:@"transform.rotation.x"];
+                } else if ([nextKey isEqualToString:@"y"]) {
+                    [[self hackLayer] setValue:v forKeyPath:@"transform.rotation.y"];
+                } else if ([nextKey isEqualToString:@"z"]) {
+                    [[self hackLayer] setValue:v forKeyPath:@"transform.rotation.z"];
                 } else {
-                    [e raise];
+                    [NSException raise:@"XNKeyValueExtractorInvalidKeyPathException" format:@"key path %@ is not valid for %@", keyPath, current];
                 }
-
-                transform = [_hackLayer transform];
-                [value setValue:[NSValue valueWithCATransform3D:transform] forKey:initialRemainingKey];
             } else {
-                [e raise];
+                [[self hackLayer] setValue:v forKeyPath:@"transform.rotation"];
+            }
+        } else if ([key isEqualToString:@"scale"]) {
+            if (nextKey != nil) {
+                if ([nextKey isEqualToString:@"x"]) {
+                    [[self hackLayer] setValue:v forKeyPath:@"transform.scale.x"];
+                } else if ([nextKey isEqualToString:@"y"]) {
+                    [[self hackLayer] setValue:v forKeyPath:@"transform.scale.y"];
+                } else if ([nextKey isEqualToString:@"z"]) {
+                    [[self hackLayer] setValue:v forKeyPath:@"transform.scale.z"];
+                } else {
+                    [NSException raise:@"XNKeyValueExtractorInvalidKeyPathException" format:@"key path %@ is not valid for %@", keyPath, current];
+                }
+            } else {
+                [[self hackLayer] setValue:v forKeyPath:@"transform.scale"];
+            }
+        } else if ([key isEqualToString:@"translation"]) {
+            if (nextKey != nil) {
+                if ([nextKey isEqualToString:@"x"]) {
+                    [[self hackLayer] setValue:v forKeyPath:@"transform.translation.x"];
+                } else if ([nextKey isEqualToString:@"y"]) {
+                    [[self hackLayer] setValue:v forKeyPath:@"transform.translation.y"];
+                } else if ([nextKey isEqualToString:@"z"]) {
+                    [[self hackLayer] setValue:v forKeyPath:@"transform.translation.z"];
+                } else {
+                    [NSException raise:@"XNKeyValueExtractorInvalidKeyPathException" format:@"key path %@ is not valid for %@", keyPath, current];
+                }
+            } else {
+                [[self hackLayer] setValue:v forKeyPath:@"transform.translation"];
             }
         } else {
-            [e raise];
+            [NSException raise:@"XNKeyValueExtractorInvalidKeyPathException" format:@"key path %@ is not valid for %@", keyPath, current];
         }
+
+        transform = [[self hackLayer] transform];
+        return [NSValue valueWithCATransform3D:transform];
+    } else {
+        [NSException raise:@"XNKeyValueExtractorInvalidKeyPathException" format:@"key path %@ is not valid for %@", keyPath, current];
     }
+
+    return nil;
 }
 
 - (NSString *)flattenedTypeEncodingForTypeEncoding:(const char *)types totalSize:(NSUInteger *)outTotalSize {
@@ -461,46 +493,41 @@
 }
 
 - (NSArray *)componentsForValue:(NSValue *)value {
-    NSMutableArray *components = [NSMutableArray array];
-
     const char *typeEncoding = [value objCType];
     NSUInteger totalSize = 0;
     NSString *flattened = [self flattenedTypeEncodingForTypeEncoding:typeEncoding totalSize:&totalSize];
     const char *flattenedTypes = [flattened UTF8String];
+    NSUInteger count = strlen(flattenedTypes);
 
     void *bytes = malloc(totalSize);
     [value getValue:bytes];
-    NSUInteger offset = 0;
 
-    for (NSUInteger i = 0; i < strlen(flattenedTypes); i++) {
-        char type = flattenedTypes[i];
+    double values[count];
+    BOOL unpacked = XNCoreComponentsUnpack(flattenedTypes, bytes, values);
+
+    free(bytes);
 
-        char typestr[2] = { type, 0 };
-        NSUInteger size = 0;
-        NSGetSizeAndAlignment(typestr, NULL, &size);
+    if (!unpacked) {
+        [NSException raise:@"XNKeyValueExtractorUnsupportedTypeException" format:@"type %s not supported", typeEncoding];
+    }
+
+    NSMutableArray *components = [NSMutableArray arrayWithCapacity:count];
 
+    for (NSUInteger i = 0; i < count; i++) {
+        char type = flattenedTypes[i];
         NSNumber *number = nil;
 
         if (type == @encode(float)[0]) {
-            float f;
-            memcpy(&f, (bytes + offset), size);
-            number = [NSNumber numberWithFloat:f];
+            number = [NSNumber numberWithFloat:values[i]];
         } else if (type == @encode(double)[0]) {
-            double d;
-            memcpy(&d, (bytes + offset), size);
-            number = [NSNumber numberWithDouble:d];
+            number = [NSNumber numberWithDouble:values[i]];
         } else {
-            long long value = 0;
-            memcpy(&value, (bytes + offset), size);
-            number = [NSNumber numberWithLongLong:value];
+            number = [NSNumber numberWithLongLong:values[i]];
         }
 
-        offset += size;
         [components addObject:number];
     }
 
-    free(bytes);
-
     return components;
 }
 
@@ -510,65 +537,25 @@
     NSUInteger totalSize = 0;
     NSString *flattened = [self flattenedTypeEncodingForTypeEncoding:types totalSize:&totalSize];
     const char *flattenedTypes = [flattened UTF8String];
+    NSUInteger count = strlen(flattenedTypes);
 
-    if (strlen(flattenedTypes) == 1) {
+    if (count == 1) {
         return [components objectAtIndex:0];
     } else {
+        double values[count];
+
+        for (NSUInteger i = 0; i < count; i++) {
+            values[i] = [[components objectAtIndex:i] doubleValue];
+        }
+
         void *bytes = calloc(1, totalSize);
-        NSUInteger offset = 0;
-
-        for (NSUInteger i = 0; i < strlen(flattenedTypes); i++) {
-            char type = flattenedTypes[i];
-            NSNumber *part = [components objectAtIndex:i];
-
-            char typestr[2] = { type, 0 };
-            NSUInteger size = 0;
-            NSGetSizeAndAlignment(typestr, NULL, &size);
-
-            if (type == @encode(float)[0]) {
-                float f = [part floatValue];
-                memcpy(bytes + offset, &f, sizeof(f));
-            } else if (type == @encode(double)[0]) {
-                double d = [part doubleValue];
-                memcpy(bytes + offset, &d, sizeof(d));
-            } else if (type == @encode(char)[0]) {
-                char c = [part charValue];
-                memcpy(bytes + offset, &c, sizeof(c));
-            } else if (type == @encode(int)[0]) {
-                int i = [part intValue];
-                memcpy(bytes + offset, &i, sizeof(i));
-            } else if (type == @encode(short)[0]) {
-                short s = [part shortValue];
-                memcpy(bytes + offset, &s, sizeof(s));
-            } else if (type == @encode(long)[0]) {
-                long l = [part longValue];
-                memcpy(bytes + offset, &l, sizeof(l));
-            } else if (type == @encode(long long)[0]) {
-                long long ll = [part longLongValue];
-                memcpy(bytes + offset, &ll, sizeof(ll));
-            } else if (type == @encode(unsigned char)[0]) {
-                unsigned char uc = [part unsignedCharValue];
-                memcpy(bytes + offset, &uc, sizeof(uc));
-            } else if (type == @encode(unsigned int)[0]) {
-                unsigned int ui = [part unsignedIntValue];
-                memcpy(bytes + offset, &ui, sizeof(ui));
-            } else if (type == @encode(unsigned short)[0]) {
-                unsigned short us = [part unsignedShortValue];
-                memcpy(bytes + offset, &us, sizeof(us));
-            } else if (type == @encode(unsigned long)[0]) {
-                unsigned long long ul = [part unsignedLongValue];
-                memcpy(bytes + offset, &ul, sizeof(ul));
-            } else if (type == @encode(unsigned long long)[0]) {
-                unsigned long long ull = [part unsignedLongLongValue];
-                memcpy(bytes + offset, &ull, sizeof(ull));
-            } else if (type == @encode(_Bool)[0]) {
-                _Bool b = [part boolValue];
-                memcpy(bytes + offset, &b, sizeof(b));
-            }
-            
-            offset += size;
+        BOOL packed = XNCoreComponentsPack(flattenedTypes, values, bytes);
+
+        if (!packed) {
+            free(bytes);
+            [NSException raise:@"XNKeyValueExtractorUnsupportedTypeException" format:@"type %s not supported", types];
         }
-        
+
         NSValue *value = [NSValue valueWithBytes:bytes objCType:types];
         free(bytes);
         return value;
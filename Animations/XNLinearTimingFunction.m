@@ -8,6 +8,8 @@
 
 #import "XNLinearTimingFunction.h"
 
+#import "XNCoreTiming.h"
+
 @implementation XNLinearTimingFunction
 
 - (id)copyWithZone:(NSZone *)zone {
@@ -15,18 +17,10 @@
     return copy;
 }
 
-- (CGFloat)simulateIndex:(NSUInteger)i elapsed:(NSTimeInterval)elapsed duration:(CGFloat)duration complete:(BOOL *)outComplete {
-    [super simulateIndex:i elapsed:elapsed duration:duration complete:outComplete];
-
-    CGFloat x = (elapsed / duration);
-
-    if (x >= 1.0) {
-        *outComplete = YES;
-        return 1.0;
-    } else {
-        *outComplete = NO;
-        return x;
-    }
+- (void)simulateCount:(NSUInteger)count elapsed:(NSTimeInterval)elapsed durations:(const double *)durations fromComponents:(const double *)from toComponents:(const double *)to positions:(double *)positions complete:(BOOL *)outComplete {
+    bool complete = false;
+    XNCoreLinearEvaluateBatch(count, elapsed, durations, from, to, positions, &complete);
+    *outComplete = complete;
 }
 
 @end
@@ -60,6 +60,7 @@ typedef NSInteger XNScrollViewIndicatorStyle;
 @property (nonatomic, retain, readonly) UIPanGestureRecognizer *panGestureRecognizer;
 //@property (nonatomic, assign) BOOL delaysContentTouches;
 @property (nonatomic, assign) BOOL canCancelContentTouches;
+@property (nonatomic, assign) BOOL predictsTouches; // default NO; scroll ahead to hide touch latency while dragging
 
 //- (BOOL)touchesShouldBegin:(NSSet *)touches withEvent:(UIEvent *)event inContentView:(UIView *)view;
 - (BOOL)touchesShouldCancelInContentView:(UIView *)view;
@@ -86,3 +87,11 @@ typedef NSInteger XNScrollViewIndicatorStyle;
 //- (void)scrollViewDidScrollToTop:(XNScrollView *)scrollView;
 
 @end
+
+@interface XNScrollView (Private)
+
+// Sets up a scroll model (see XNCoreScroll.h) with the physics of this device,
+// as each scroll view's own is.
++ (void)_initializeScrollModel:(struct XNCoreScroll *)scroll;
+
+@end
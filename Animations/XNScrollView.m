@@ -11,6 +11,9 @@
 #import <UIKit/UIGestureRecognizerSubclass.h>
 
 #import "XNScrollView.h"
+#import "XNTraceRecorder.h"
+
+#import "XNCoreScroll.h"
 
 // iOS 6 introduces a new formula for this, depending on the dimensions of the
 // scroll view as well as a constant. This option can either emulate that new
@@ -18,9 +21,6 @@
 const static BOOL kXNScrollViewElasticSimpleFormula = (__IPHONE_OS_VERSION_MAX_ALLOWED < 60000);
 const static CGFloat kXNScrollViewElasticConstant = 0.55f;
 
-const static CGFloat kXNScrollViewDecelerationMinimumVelocity = 250.0f;
-const static CGFloat kXNScrollViewDecelerationCurrentVelocityFactor = 0.25f;
-
 const CGFloat XNScrollViewDecelerationRateNormal = 0.998f;
 const CGFloat XNScrollViewDecelerationRateFast = 0.990f;
 
@@ -32,39 +32,33 @@ const static CGFloat kXNScrollViewIndicatorCornerDimension = 6.0f;
 const static NSTimeInterval kXNScrollViewIndicatorAnimationDuration = 0.25f;
 const static NSTimeInterval kXNScrollViewIndicatorFlashingDuration = 0.75f;
 
-@interface XNScrollViewIndicator : UIView
+static CGPoint XNScrollViewPointFromCore(XNCoreScrollPoint point) {
+    return CGPointMake(point.x, point.y);
+}
+
+static XNCoreScrollPoint XNScrollViewCorePointFromPoint(CGPoint point) {
+    XNCoreScrollPoint corePoint = { point.x, point.y };
+    return corePoint;
+}
+
+@interface XNScrollViewIndicator : UIImageView
 
 @property (nonatomic, assign) XNScrollViewIndicatorStyle indicatorStyle;
 
 @end
 
+// Indicators are drawn once per style and screen scale, then stretched to
+// size. The images are shared between all scroll views, so resizing an
+// indicator (which happens every frame near the edges) never redraws it.
+static NSMutableDictionary *XNScrollViewIndicatorImageCache = nil;
+
 @implementation XNScrollViewIndicator {
     XNScrollViewIndicatorStyle _indicatorStyle;
 }
 
 @synthesize indicatorStyle = _indicatorStyle;
 
-- (id)initWithFrame:(CGRect)frame {
-    if ((self = [super initWithFrame:frame])) {
-        [self setOpaque:NO];
-    }
-
-    return self;
-}
-
-- (void)setFrame:(CGRect)frame {
-    [super setFrame:frame];
-
-    [self setNeedsDisplay];
-}
-
-- (void)setIndicatorStyle:(XNScrollViewIndicatorStyle)indicatorStyle {
-    _indicatorStyle = indicatorStyle;
-
-    [self setNeedsDisplay];
-}
-
-- (void)drawRect:(CGRect)rect {
++ (void)drawIndicatorStyle:(XNScrollViewIndicatorStyle)indicatorStyle inRect:(CGRect)rect {
     UIColor *lightColor = [UIColor colorWithWhite:1.0f alpha:0.5f];
     UIColor *lightBorderColor = [UIColor colorWithWhite:1.0f alpha:0.3f];
     UIColor *darkColor = [UIColor colorWithWhite:0.0f alpha:0.5f];
@@ -74,9 +68,9 @@ const static NSTimeInterval kXNScrollViewIndicatorFlashingDuration = 0.75f;
 
     CGRect insideRect = CGRectInset(barRect, 1.0f, 1.0f);
     
-    if ([self indicatorStyle] == XNScrollViewIndicatorStyleDefault) {
+    if (indicatorStyle == XNScrollViewIndicatorStyleDefault) {
         [darkColor setFill];
-    } else if ([self indicatorStyle] == XNScrollViewIndicatorStyleWhite) {
+    } else if (indicatorStyle == XNScrollViewIndicatorStyleWhite) {
         [lightColor setFill];
     } else {
         [darkColor setFill];
@@ -86,7 +80,7 @@ const static NSTimeInterval kXNScrollViewIndicatorFlashingDuration = 0.75f;
     UIBezierPath *innerPath = [UIBezierPath bezierPathWithRoundedRect:insideRect cornerRadius:(insideShortLength / 2.0f)];
     [innerPath fill];
 
-    if ([self indicatorStyle] == XNScrollViewIndicatorStyleDefault) {
+    if (indicatorStyle == XNScrollViewIndicatorStyleDefault) {
         [lightBorderColor setFill];
 
         UIBezierPath *outerPath = [UIBezierPath bezierPathWithRoundedRect:barRect cornerRadius:(barShortLength / 2.0f)];
@@ -96,6 +90,53 @@ const static NSTimeInterval kXNScrollViewIndicatorFlashingDuration = 0.75f;
     }
 }
 
++ (UIImage *)imageForIndicatorStyle:(XNScrollViewIndicatorStyle)indicatorStyle scale:(CGFloat)scale {
+    if (XNScrollViewIndicatorImageCache == nil) {
+        XNScrollViewIndicatorImageCache = [[NSMutableDictionary alloc] init];
+    }
+
+    NSString *key = [NSString stringWithFormat:@"%ld@%f", (long) indicatorStyle, scale];
+    UIImage *image = [XNScrollViewIndicatorImageCache objectForKey:key];
+
+    if (image == nil) {
+        // Both caps are the rounded ends; the single point between them is
+        // the straight part of the bar, which is what gets stretched.
+        CGFloat cap = floorf(kXNScrollViewIndicatorMinimumDimension / 2.0f);
+        CGRect rect = CGRectMake(0, 0, kXNScrollViewIndicatorMinimumDimension, kXNScrollViewIndicatorMinimumDimension);
+
+        UIGraphicsBeginImageContextWithOptions(rect.size, NO, scale);
+        [self drawIndicatorStyle:indicatorStyle inRect:rect];
+        UIImage *drawn = UIGraphicsGetImageFromCurrentImageContext();
+        UIGraphicsEndImageContext();
+
+        image = [drawn resizableImageWithCapInsets:UIEdgeInsetsMake(cap, cap, cap, cap)];
+        [XNScrollViewIndicatorImageCache setObject:image forKey:key];
+    }
+
+    return image;
+}
+
+- (id)initWithFrame:(CGRect)frame {
+    if ((self = [super initWithFrame:frame])) {
+        [self setOpaque:NO];
+
+        _indicatorStyle = XNScrollViewIndicatorStyleDefault;
+        [self setImage:[[self class] imageForIndicatorStyle:_indicatorStyle scale:[[UIScreen mainScreen] scale]]];
+    }
+
+    return self;
+}
+
+- (void)setIndicatorStyle:(XNScrollViewIndicatorStyle)indicatorStyle {
+    if (indicatorStyle == _indicatorStyle) {
+        return;
+    }
+
+    _indicatorStyle = indicatorStyle;
+
+    [self setImage:[[self class] imageForIndicatorStyle:_indicatorStyle scale:[[UIScreen mainScreen] scale]]];
+}
+
 @end
 
 @interface XNScrollViewPanGestureRecognizer : UIPanGestureRecognizer
@@ -104,16 +145,19 @@ const static NSTimeInterval kXNScrollViewIndicatorFlashingDuration = 0.75f;
 @property (nonatomic, assign, readonly) XNScrollView *scrollView;
 
 @property (nonatomic, assign, readonly, getter=isTracking) BOOL tracking;
+@property (nonatomic, assign, readonly) NSTimeInterval timestamp; // of the latest touch event
 
 @end
 
 @implementation XNScrollViewPanGestureRecognizer {
     XNScrollView *_scrollView;
     BOOL _tracking;
+    NSTimeInterval _timestamp;
 }
 
 @synthesize scrollView = _scrollView;
 @synthesize tracking = _tracking;
+@synthesize timestamp = _timestamp;
 
 - (id)initWithTarget:(id)target action:(SEL)action scrollView:(XNScrollView *)scrollView {
     if ((self = [super initWithTarget:target action:action])) {
@@ -130,11 +174,14 @@ const static NSTimeInterval kXNScrollViewIndicatorFlashingDuration = 0.75f;
     }
 
     _tracking = YES;
+    _timestamp = [event timestamp];
 
     [super touchesBegan:touches withEvent:event];
 }
 
 - (void)touchesMoved:(NSSet *)touches withEvent:(UIEvent *)event {
+    _timestamp = [event timestamp];
+
     [super touchesMoved:touches withEvent:event];
 
     if ([self state] == UIGestureRecognizerStateBegan) {
@@ -161,6 +208,7 @@ const static NSTimeInterval kXNScrollViewIndicatorFlashingDuration = 0.75f;
 
 - (void)touchesEnded:(NSSet *)touches withEvent:(UIEvent *)event {
     _tracking = NO;
+    _timestamp = [event timestamp];
 
     [super touchesEnded:touches withEvent:event];
 }
@@ -174,6 +222,12 @@ const static NSTimeInterval kXNScrollViewIndicatorFlashingDuration = 0.75f;
 @end
 
 @interface XNScrollView () <XNAnimationDelegate>
+
+// Drives dragging, for the pan gesture recognizer once it has been traced.
+// Translation is of the finger in the scroll view, and timestamps are in
+// media time.
+- (void)_panWithState:(UIGestureRecognizerState)state translation:(CGPoint)translation timestamp:(NSTimeInterval)timestamp;
+
 @end
 
 @implementation XNScrollView {
@@ -183,14 +237,11 @@ const static NSTimeInterval kXNScrollViewIndicatorFlashingDuration = 0.75f;
 
     CGFloat _decelerationRate;
 
-    CGPoint _throwTranslation;
-    CGPoint _throwVelocity;
-
-  CGPoint _previousVelocity;
-  CGPoint _previousPreviousVelocity;
+    // Dragging and deceleration; the content offset follows the animation
+    // while decelerating, so it's only current in the view.
+    XNCoreScroll _scroll;
 
     XNScrollViewPanGestureRecognizer *_panGestureRecognizer;
-    CGPoint _panStartContentOffset;
     XNAnimation *_scrollAnimation;
 
     UIEdgeInsets _scrollIndicatorInsets;
@@ -220,15 +271,11 @@ const static NSTimeInterval kXNScrollViewIndicatorFlashingDuration = 0.75f;
         BOOL __alwaysBounceVertical:1;
 #define _alwaysBounceVertical _flags.__alwaysBounceVertical
 
-        BOOL __dragging:1;
-#define _dragging _flags.__dragging
-        BOOL __decelerating:1;
-#define _decelerating _flags.__decelerating
-        BOOL __scrolling:1;
-#define _scrolling _flags.__scrolling
-
         BOOL __canCancelContentTouches:1;
 #define _canCancelContentTouches _flags.__canCancelContentTouches
+
+        BOOL __predictsTouches:1;
+#define _predictsTouches _flags.__predictsTouches
     } _flags;
 
     id<XNScrollViewDelegate> _delegate;
@@ -442,15 +489,15 @@ const static NSTimeInterval kXNScrollViewIndicatorFlashingDuration = 0.75f;
 }
 
 - (BOOL)isDecelerating {
-    return _decelerating;
+    return _scroll.decelerating;
 }
 
 - (BOOL)isDragging {
-    return _dragging;
+    return _scroll.dragging;
 }
 
 - (BOOL)isScrolling {
-    return _scrolling;
+    return _scroll.scrolling;
 }
 
 - (BOOL)isTracking {
@@ -473,6 +520,14 @@ const static NSTimeInterval kXNScrollViewIndicatorFlashingDuration = 0.75f;
     [panGestureRecognizer setEnabled:scrollEnabled];
 }
 
+- (BOOL)predictsTouches {
+    return _predictsTouches;
+}
+
+- (void)setPredictsTouches:(BOOL)predictsTouches {
+    _predictsTouches = predictsTouches;
+}
+
 - (BOOL)canCancelContentTouches {
     return _canCancelContentTouches;
 }
@@ -532,7 +587,7 @@ const static NSTimeInterval kXNScrollViewIndicatorFlashingDuration = 0.75f;
 }
 
 - (void)stopScrolling {
-    if (_dragging && [_panGestureRecognizer state] != UIGestureRecognizerStateBegan) {
+    if (_scroll.dragging && [_panGestureRecognizer state] != UIGestureRecognizerStateBegan) {
         [_panGestureRecognizer setEnabled:NO];
         [_panGestureRecognizer setEnabled:YES];
     }
@@ -568,6 +623,8 @@ const static NSTimeInterval kXNScrollViewIndicatorFlashingDuration = 0.75f;
 
 - (id)initWithFrame:(CGRect)frame {
     if ((self = [super initWithFrame:frame])) {
+        [[self class] _initializeScrollModel:&_scroll];
+
         _scrollEnabled = YES;
         _bounces = YES;
 
@@ -584,9 +641,11 @@ const static NSTimeInterval kXNScrollViewIndicatorFlashingDuration = 0.75f;
         XNBezierTimingFunction *indicatorTimingFunction = [XNBezierTimingFunction timingFunctionWithControlPoints:[XNBezierTimingFunction controlPointsEaseInOut]];
         _horizontalScrollIndicatorAnimation = [[XNAnimation alloc] initWithKeyPath:@"alpha"];
         [_horizontalScrollIndicatorAnimation setTimingFunction:indicatorTimingFunction];
+        [_horizontalScrollIndicatorAnimation setPriority:XNAnimationPriorityDecorative];
         [_horizontalScrollIndicatorAnimation setDelegate:self];
         _verticalScrollIndicatorAnimation = [[XNAnimation alloc] initWithKeyPath:@"alpha"];
         [_verticalScrollIndicatorAnimation setTimingFunction:indicatorTimingFunction];
+        [_verticalScrollIndicatorAnimation setPriority:XNAnimationPriorityDecorative];
         [_verticalScrollIndicatorAnimation setDelegate:self];
 
         _panGestureRecognizer = [[XNScrollViewPanGestureRecognizer alloc] initWithTarget:self action:@selector(_panFromGestureRecognizer:) scrollView:self];
@@ -599,10 +658,14 @@ const static NSTimeInterval kXNScrollViewIndicatorFlashingDuration = 0.75f;
         _scrollAnimation = [[XNAnimation alloc] initWithKeyPath:@"contentOffset"];
         [_scrollAnimation setTimingFunction:[XNDecayTimingFunction timingFunction]];
         [self setDecelerationRate:XNScrollViewDecelerationRateNormal];
+        [_scrollAnimation setRestDistance:_scroll.restDistance];
+        [_scrollAnimation setRestVelocity:_scroll.restVelocity];
+        [_scrollAnimation setPriority:XNAnimationPriorityInteractive];
         [_scrollAnimation setDelegate:self];
 
         _offsetAnimation = [[XNAnimation alloc] initWithKeyPath:@"contentOffset"];
         [_offsetAnimation setTimingFunction:[XNSpringTimingFunction timingFunctionWithTension:100.0f damping:20.0f mass:1.0f]];
+        [_offsetAnimation setPriority:XNAnimationPriorityInteractive];
         [_offsetAnimation setDelegate:self];
     }
 
@@ -627,28 +690,44 @@ const static NSTimeInterval kXNScrollViewIndicatorFlashingDuration = 0.75f;
 
 #pragma mark - Computed State
 
++ (void)_initializeScrollModel:(struct XNCoreScroll *)scroll {
+    XNCoreScrollInit(scroll);
 
-- (CGRect)_effectiveScrollBounds {
+    scroll->elasticSimpleFormula = kXNScrollViewElasticSimpleFormula;
+    scroll->elasticConstant = kXNScrollViewElasticConstant;
+
+    // Half a pixel, as XNAnimation's default for points.
+    XNCoreScrollSetScreenScale(scroll, [[UIScreen mainScreen] scale]);
+}
+
+- (void)_updateScrollModel {
     CGRect bounds = [self bounds];
     CGSize contentSize = [self contentSize];
     UIEdgeInsets contentInset = [self contentInset];
 
-    if (contentSize.width < bounds.size.width) {
-        contentSize.width = bounds.size.width;
-    } else if (contentSize.height < bounds.size.height) {
-        contentSize.height = bounds.size.height;
-    }
+    _scroll.boundsWidth = bounds.size.width;
+    _scroll.boundsHeight = bounds.size.height;
+    _scroll.contentWidth = contentSize.width;
+    _scroll.contentHeight = contentSize.height;
+    _scroll.insetTop = contentInset.top;
+    _scroll.insetLeft = contentInset.left;
+    _scroll.insetBottom = contentInset.bottom;
+    _scroll.insetRight = contentInset.right;
 
-    CGRect scrollBounds = CGRectZero;
-    scrollBounds.origin.x = 0;
-    scrollBounds.origin.y = 0;
-    scrollBounds.size.width = contentSize.width - bounds.size.width;
-    scrollBounds.size.height = contentSize.height - bounds.size.height;
+    _scroll.bounces = [self bounces];
+    _scroll.alwaysBounceHorizontal = [self alwaysBounceHorizontal];
+    _scroll.alwaysBounceVertical = [self alwaysBounceVertical];
+    _scroll.predictsTouches = [self predictsTouches];
+    _scroll.decelerationRate = [self decelerationRate];
 
-    UIEdgeInsets invertedInsets = UIEdgeInsetsMake(-contentInset.top, -contentInset.left, -contentInset.bottom, -contentInset.right);
-    scrollBounds = UIEdgeInsetsInsetRect(scrollBounds, invertedInsets);
+    _scroll.contentOffset = XNScrollViewCorePointFromPoint(bounds.origin);
+}
+
+- (CGRect)_effectiveScrollBounds {
+    [self _updateScrollModel];
 
-    return scrollBounds;
+    XNCoreScrollRect scrollBounds = XNCoreScrollBounds(&_scroll);
+    return CGRectMake(scrollBounds.x, scrollBounds.y, scrollBounds.width, scrollBounds.height);
 }
 
 - (BOOL)_effectiveScrollsHorizontally {
@@ -661,14 +740,6 @@ const static NSTimeInterval kXNScrollViewIndicatorFlashingDuration = 0.75f;
     return (scrollBounds.size.height > 0);
 }
 
-- (BOOL)_effectiveBouncesHorizontally {
-    return [self bounces] && ([self alwaysBounceHorizontal] || [self _effectiveScrollsHorizontally]);
-}
-
-- (BOOL)_effectiveBouncesVertically {
-    return [self bounces] && ([self alwaysBounceVertical] || [self _effectiveScrollsVertically]);
-}
-
 - (BOOL)_effectiveShowsHorizontalScrollIndicator {
     return [self showsHorizontalScrollIndicator] && [self _effectiveScrollsHorizontally];
 }
@@ -679,60 +750,6 @@ const static NSTimeInterval kXNScrollViewIndicatorFlashingDuration = 0.75f;
 
 #pragma mark - Graphical Computation
 
-- (CGFloat)_elasticDistanceForDistance:(CGFloat)distance constant:(CGFloat)constant range:(CGFloat)range {
-    if (kXNScrollViewElasticSimpleFormula) {
-        distance = distance * constant;
-    } else {
-        distance = (distance * constant * range) / (distance * constant + range);
-    }
-    
-    return distance;
-}
-
-- (CGPoint)_constrainContentOffset:(CGPoint)offset toScrollBounds:(CGRect)scrollBounds elastic:(BOOL)elastic {
-    CGFloat elasticConstant = (elastic ? kXNScrollViewElasticConstant : 0.0f);
-    CGFloat horizontalConstant = ([self _effectiveBouncesHorizontally] ? elasticConstant : 0.0f);
-    CGFloat verticalConstant = ([self _effectiveBouncesVertically] ? elasticConstant : 0.0f);
-
-    if (offset.x < CGRectGetMinX(scrollBounds)) {
-        CGFloat range = [self bounds].size.width;
-        CGFloat edge = CGRectGetMinX(scrollBounds);
-        
-        CGFloat distance = fabsf(offset.x - edge);
-        distance = [self _elasticDistanceForDistance:distance constant:horizontalConstant range:range];
-        
-        offset.x = edge - distance;
-    } else if (offset.x > CGRectGetMaxX(scrollBounds)) {
-        CGFloat range = [self bounds].size.width;
-        CGFloat edge = CGRectGetMaxX(scrollBounds);
-
-        CGFloat distance = fabsf(offset.x - edge);
-        distance = [self _elasticDistanceForDistance:distance constant:horizontalConstant range:range];
-
-        offset.x = edge + distance;
-    }
-
-    if (offset.y < CGRectGetMinY(scrollBounds)) {
-        CGFloat range = [self bounds].size.height;
-        CGFloat edge = CGRectGetMinY(scrollBounds);
-
-        CGFloat distance = fabsf(offset.y - edge);
-        distance = [self _elasticDistanceForDistance:distance constant:verticalConstant range:range];
-
-        offset.y = edge - distance;
-    } else if (offset.y > CGRectGetMaxY(scrollBounds)) {
-        CGFloat range = [self bounds].size.height;
-        CGFloat edge = CGRectGetMaxY(scrollBounds);
-
-        CGFloat distance = fabsf(offset.y - edge);
-        distance = [self _elasticDistanceForDistance:distance constant:verticalConstant range:range];
-
-        offset.y = edge + distance;
-    }
-
-    return offset;
-}
-
 - (CGFloat)_lengthForIndicatorWithDimension:(CGFloat)dimension contentDimension:(CGFloat)contentDimension position:(CGFloat)position {
     CGFloat outside = 0;
     CGFloat minimum = kXNScrollViewIndicatorMinimumInsideLength;
@@ -783,8 +800,7 @@ const static NSTimeInterval kXNScrollViewIndicatorFlashingDuration = 0.75f;
 
 - (void)animationStopped:(XNAnimation *)animation {
     if (animation == _scrollAnimation) {
-        _decelerating = NO;
-        _scrolling = NO;
+        XNCoreScrollStop(&_scroll);
         [self _delegateDidEndDecelerating];
         [self _delegateDidEndScrolling];
 
@@ -817,23 +833,13 @@ const static NSTimeInterval kXNScrollViewIndicatorFlashingDuration = 0.75f;
         // support to the animation itself. Instead, just cap the values from
         // the animation to what they should be for when bouncing is disabled.
 
-        BOOL effectiveHorizontal = [self _effectiveBouncesHorizontally];
-        BOOL effectiveVertical = [self _effectiveBouncesVertically];
+        [self _updateScrollModel];
 
-        if (!effectiveHorizontal || !effectiveVertical) {
-            CGRect scrollBounds = [self _effectiveScrollBounds];
-            CGPoint offset = [self contentOffset];
-            CGPoint constrained = [self _constrainContentOffset:offset toScrollBounds:scrollBounds elastic:NO];
+        XNCoreScrollPoint offset = _scroll.contentOffset;
+        XNCoreScrollPoint constrained = XNCoreScrollConstrainBounceless(&_scroll, offset);
 
-            if (!effectiveHorizontal) {
-                offset.x = constrained.x;
-            }
-
-            if (!effectiveVertical) {
-                offset.y = constrained.y;
-            }
-
-            [self setContentOffset:offset];
+        if (constrained.x != offset.x || constrained.y != offset.y) {
+            [self setContentOffset:XNScrollViewPointFromCore(constrained)];
         }
     }
 }
@@ -941,42 +947,34 @@ const static NSTimeInterval kXNScrollViewIndicatorFlashingDuration = 0.75f;
 }
 
 - (void)_updateForGeometryChange {
-    if ([self isDecelerating]) {
-        [self _updateThrowParameters];
+    [self _updateScrollModel];
+
+    if (XNCoreScrollGeometryChanged(&_scroll)) {
+        [self setContentOffset:XNScrollViewPointFromCore(_scroll.contentOffset)];
     }
 
-    if (![self isDragging]) {
-        CGPoint contentOffset = [self contentOffset];
-        CGRect scrollBounds = [self _effectiveScrollBounds];
+    // After moving back within the bounds, as the replay will.
+    XNTraceRecorder *recorder = [XNTraceRecorder activeRecorder];
 
-        if (!CGRectContainsPoint(scrollBounds, contentOffset)) {
-            contentOffset = [self _constrainContentOffset:contentOffset toScrollBounds:scrollBounds elastic:NO];
-            [self setContentOffset:contentOffset];
-        }
+    if ([recorder scrollView] == self) {
+        [recorder recordGeometryWithBounds:[self bounds] contentSize:[self contentSize] contentInset:[self contentInset] timestamp:CACurrentMediaTime()];
+    }
+
+    if ([self isDecelerating]) {
+        [self _updateThrowParameters];
     }
 }
 
 - (void)_updateThrowParameters {
-    CGRect scrollBounds = [self _effectiveScrollBounds];
-
-    NSValue *fromValue = [NSValue valueWithCGPoint:_throwTranslation];
-    NSValue *velocityValue = [NSValue valueWithCGPoint:_throwVelocity];
-    NSValue *toValue = [XNDecayTimingFunction toValueFromValue:fromValue forVelocity:velocityValue withConstant:[self decelerationRate]];
-
-    CGPoint boundedTranslation = [toValue CGPointValue];
-    boundedTranslation = [self _constrainContentOffset:boundedTranslation toScrollBounds:scrollBounds elastic:NO];
-    NSValue *boundedToValue = [NSValue valueWithCGPoint:boundedTranslation];
-
-    CGPoint minimum = CGPointMake(CGRectGetMinX(scrollBounds), CGRectGetMinY(scrollBounds));
-    NSValue *minimumValue = [NSValue valueWithCGPoint:minimum];
-    CGPoint maximum = CGPointMake(CGRectGetMaxX(scrollBounds), CGRectGetMaxY(scrollBounds));
-    NSValue *maximumValue = [NSValue valueWithCGPoint:maximum];
-    id insideValue = [XNDecayTimingFunction insideValueFromValue:fromValue toValue:boundedToValue minimumValue:minimumValue maximumValue:maximumValue];
+    NSValue *fromValue = [NSValue valueWithCGPoint:XNScrollViewPointFromCore(_scroll.throwFrom)];
+    NSValue *toValue = [NSValue valueWithCGPoint:XNScrollViewPointFromCore(_scroll.throwTo)];
+    NSValue *velocityValue = [NSValue valueWithCGPoint:XNScrollViewPointFromCore(_scroll.throwVelocity)];
+    NSArray *insideValue = [NSArray arrayWithObjects:[NSNumber numberWithBool:_scroll.throwInside[0]], [NSNumber numberWithBool:_scroll.throwInside[1]], nil];
 
     XNDecayTimingFunction *timingFunction = (XNDecayTimingFunction *) [_scrollAnimation timingFunction];
     [timingFunction setInsideValue:insideValue];
 
-    [_scrollAnimation setToValue:boundedToValue];
+    [_scrollAnimation setToValue:toValue];
     [_scrollAnimation setFromValue:fromValue];
     [_scrollAnimation setVelocity:velocityValue];
 }
@@ -985,77 +983,54 @@ const static NSTimeInterval kXNScrollViewIndicatorFlashingDuration = 0.75f;
     NSAssert(recognizer == _panGestureRecognizer, @"invalid recognizer");
 
     UIGestureRecognizerState state = [_panGestureRecognizer state];
+    CGPoint translation = [_panGestureRecognizer translationInView:self];
+    NSTimeInterval timestamp = [_panGestureRecognizer timestamp];
+
+    XNTraceRecorder *recorder = [XNTraceRecorder activeRecorder];
 
+    if ([recorder scrollView] == self) {
+        if (state == UIGestureRecognizerStateBegan) {
+            [recorder recordGeometryWithBounds:[self bounds] contentSize:[self contentSize] contentInset:[self contentInset] timestamp:timestamp];
+        }
+
+        [recorder recordPanWithState:state translation:translation timestamp:timestamp];
+    }
+
+    [self _panWithState:state translation:translation timestamp:timestamp];
+}
+
+- (void)_panWithState:(UIGestureRecognizerState)state translation:(CGPoint)translation timestamp:(NSTimeInterval)timestamp {
     if (state == UIGestureRecognizerStateBegan) {
         [self stopScrolling];
 
         [self _delegateWillBeginScrolling];
         [self _delegateWillBeginDragging];
-        _dragging = YES;
-        _scrolling = YES;
+    }
+
+    [self _updateScrollModel];
 
-        _previousVelocity = CGPointZero;
-        _previousPreviousVelocity = CGPointZero;
+    XNCoreScrollPoint coreTranslation = XNScrollViewCorePointFromPoint(translation);
+    XNCoreScrollPanResult result = XNCoreScrollPan(&_scroll, state, coreTranslation, timestamp, CACurrentMediaTime());
 
+    if (result == XNCoreScrollPanResultBegan) {
         [self _cancelScrollIndicatorFlash];
         [self _updateIndicatorsVisible:YES animated:NO];
+    } else if (result == XNCoreScrollPanResultCancelled) {
+        [self _delegateDidEndDraggingWillDecelerate:NO];
+        [self _delegateDidEndScrolling];
+    } else if (result == XNCoreScrollPanResultMoved) {
+        [self setContentOffset:XNScrollViewPointFromCore(_scroll.contentOffset)];
+    } else if (result == XNCoreScrollPanResultDecelerating) {
+        [self _updateThrowParameters];
 
-        _panStartContentOffset = [self contentOffset];
-    } else if (state == UIGestureRecognizerStateCancelled) {
-        _dragging = NO;
-        _scrolling = NO;
+        [self _delegateDidEndDraggingWillDecelerate:YES];
+        [self _delegateWillBeginDecelerating];
+        [self addXNAnimation:_scrollAnimation];
+    } else if (result == XNCoreScrollPanResultStopped) {
         [self _delegateDidEndDraggingWillDecelerate:NO];
         [self _delegateDidEndScrolling];
-    } else {
-        CGRect scrollBounds = [self _effectiveScrollBounds];
-
-        CGPoint velocity = [_panGestureRecognizer velocityInView:self];
-        velocity.x = -velocity.x;
-        velocity.y = -velocity.y;
-
-        CGPoint translation = [_panGestureRecognizer translationInView:self];
-        translation.x = _panStartContentOffset.x - translation.x;
-        translation.y = _panStartContentOffset.y - translation.y;
-
-        translation = [self _constrainContentOffset:translation toScrollBounds:scrollBounds elastic:YES];
-
-        if (state == UIGestureRecognizerStateChanged) {
-            _previousVelocity = velocity;
-            _previousPreviousVelocity = _previousVelocity;
-          
-            [self setContentOffset:translation];
-        } else if (state == UIGestureRecognizerStateEnded) {
-            CGFloat factor = kXNScrollViewDecelerationCurrentVelocityFactor;
-            velocity.x = _previousPreviousVelocity.x * (1 - factor) + velocity.x * factor;
-            velocity.y = _previousPreviousVelocity.y *  (1 - factor) + velocity.y * factor;
-          
-            CGFloat scalarVelocity = sqrtf(velocity.x * velocity.x + velocity.y * velocity.y);
-            BOOL stopped = (scalarVelocity <= kXNScrollViewDecelerationMinimumVelocity);
-            
-            BOOL inside = CGRectContainsPoint(scrollBounds, translation);
-
-            if (!stopped || !inside) {
-                _throwVelocity = velocity;
-                _throwTranslation = translation;
-
-                [self _updateThrowParameters];
-
-                _dragging = NO;
-
-                [self _delegateDidEndDraggingWillDecelerate:YES];
-                [self _delegateWillBeginDecelerating];
-                [self addXNAnimation:_scrollAnimation];
-
-                _decelerating = YES;
-            } else {
-                _dragging = NO;
-                _scrolling = NO;
-                [self _delegateDidEndDraggingWillDecelerate:NO];
-                [self _delegateDidEndScrolling];
 
-                [self _updateIndicatorsVisible:NO animated:YES];
-            }
-        }
+        [self _updateIndicatorsVisible:NO animated:YES];
     }
 }
 
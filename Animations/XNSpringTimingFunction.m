@@ -8,6 +8,8 @@
 
 #import "XNSpringTimingFunction.h"
 
+#import "XNCoreSpring.h"
+
 const static CGFloat kXNSpringTimingFunctionDefaultTension = 273.0f;
 const static CGFloat kXNSpringTimingFunctionDefaultDamping = 20.0f;
 const static CGFloat kXNSpringTimingFunctionDefaultMass = 1.0f;
@@ -22,6 +24,21 @@ const static CGFloat kXNSpringTimingFunctionDefaultMass = 1.0f;
 @synthesize damping = _b;
 @synthesize mass = _m;
 
+- (void)setTension:(CGFloat)tension {
+    _k = tension;
+    [self didChange];
+}
+
+- (void)setDamping:(CGFloat)damping {
+    _b = damping;
+    [self didChange];
+}
+
+- (void)setMass:(CGFloat)mass {
+    _m = mass;
+    [self didChange];
+}
+
 + (id)timingFunctionWithTension:(CGFloat)tension damping:(CGFloat)damping mass:(CGFloat)mass {
     XNSpringTimingFunction *spring = [[[self alloc] init] autorelease];
     [spring setTension:tension];
@@ -48,50 +65,12 @@ const static CGFloat kXNSpringTimingFunctionDefaultMass = 1.0f;
     return self;
 }
 
-- (CGFloat)simulateIndex:(NSUInteger)i elapsed:(NSTimeInterval)elapsed velocity:(CGFloat)velocity complete:(BOOL *)outComplete {
-    [super simulateIndex:i elapsed:elapsed velocity:velocity complete:outComplete];
-
-    CGFloat v0 = -velocity;
-    CGFloat x0 = 1.0;
-
-    CGFloat t = elapsed;
-
-    CGFloat w0 = sqrtf(_k / _m);
+- (void)simulateCount:(NSUInteger)count elapsed:(NSTimeInterval)elapsed velocities:(const double *)velocities fromComponents:(const double *)from toComponents:(const double *)to restDistance:(CGFloat)restDistance restVelocity:(CGFloat)restVelocity positions:(double *)positions complete:(BOOL *)outComplete {
+    XNCoreSpring spring = { _k, _b, _m };
 
-    CGFloat zeta = _b / (2 * sqrtf(_m * _k));
-    CGFloat x = 0;
-
-    if (zeta < 1.0f) {
-        CGFloat wD = w0 * sqrtf(1 - zeta * zeta);
-
-        CGFloat A = x0;
-        CGFloat B = (zeta * w0 * x0 + v0) / wD;
-
-        x = powf(M_E, -zeta * w0 * t) * (A * cos(wD * t) + B * sin(wD * t));
-    } else if (zeta == 1.0f) {
-        CGFloat A = x0;
-        CGFloat B = v0 * w0 * x0;
-
-        x = powf(M_E, -w0 * t) * (A + B * t);
-    } else if (zeta > 1.0f) {
-        CGFloat gP = (-_b + sqrtf(powf(_b, 2) - 4 * w0)) / 2;
-        CGFloat gM = (-_b - sqrtf(powf(_b, 2) - 4 * w0)) / 2;
-
-        CGFloat A = x0 - (gM * x0 - v0) / (gM - gP);
-        CGFloat B = (gM * x0 - v0) / (gM - gP);
-
-        x = A * powf(M_E, gM * t) + B * powf(M_E, gP * t);
-    }
-
-    x = 1.0 - x;
-
-    if (fabs(x - 1.0) <= 0.001) {
-        *outComplete = YES;
-        return 1.0;
-    } else {
-        *outComplete = NO;
-        return x;
-    }
+    bool complete = false;
+    XNCoreSpringEvaluateBatch(&spring, count, elapsed, velocities, from, to, restDistance, restVelocity, positions, &complete);
+    *outComplete = complete;
 }
 
 @end
@@ -11,10 +11,21 @@
 + (id)timingFunction;
 
 // Private
-- (NSArray *)simulateWithTimeInterval:(NSTimeInterval)dt elapsed:(NSTimeInterval)elapsed durations:(NSArray *)durations velocities:(NSArray *)velocities fromComponents:(NSArray *)fromComponents toComponents:(NSArray *)toComponents complete:(BOOL *)outComplete;
+// Changes whenever a parameter that affects simulation does, so copies made for
+// simulating can tell when they are out of date.
+@property (nonatomic, assign, readonly) NSUInteger mutations;
+
+// Rest distance and velocity are in the units of the components; velocity-based
+// timing functions are complete once both position and velocity are within them.
+- (NSArray *)simulateWithTimeInterval:(NSTimeInterval)dt elapsed:(NSTimeInterval)elapsed durations:(NSArray *)durations velocities:(NSArray *)velocities fromComponents:(NSArray *)fromComponents toComponents:(NSArray *)toComponents restDistance:(CGFloat)restDistance restVelocity:(CGFloat)restVelocity complete:(BOOL *)outComplete;
 
 // Subclasses
-- (CGFloat)simulateIndex:(NSUInteger)i elapsed:(NSTimeInterval)elapsed duration:(CGFloat)duration complete:(BOOL *)outComplete;
-- (CGFloat)simulateIndex:(NSUInteger)i elapsed:(NSTimeInterval)elapsed velocity:(CGFloat)velocity complete:(BOOL *)outComplete;
+// Call from the setter of any parameter that affects simulation.
+- (void)didChange;
+
+// Write the absolute position of each of the count components. Rest distance
+// and velocity are in the units of the components, as above.
+- (void)simulateCount:(NSUInteger)count elapsed:(NSTimeInterval)elapsed durations:(const double *)durations fromComponents:(const double *)from toComponents:(const double *)to positions:(double *)positions complete:(BOOL *)outComplete;
+- (void)simulateCount:(NSUInteger)count elapsed:(NSTimeInterval)elapsed velocities:(const double *)velocities fromComponents:(const double *)from toComponents:(const double *)to restDistance:(CGFloat)restDistance restVelocity:(CGFloat)restVelocity positions:(double *)positions complete:(BOOL *)outComplete;
 
 @end
@@ -8,7 +8,13 @@
 
 #import "XNTimingFunction.h"
 
-@implementation XNTimingFunction
+#import "XNCoreTiming.h"
+
+@implementation XNTimingFunction {
+    NSUInteger _mutations;
+}
+
+@synthesize mutations = _mutations;
 
 + (id)timingFunction {
     return [[[self alloc] init] autorelease];
@@ -19,23 +25,26 @@
     return copy;
 }
 
-- (CGFloat)simulateIndex:(NSUInteger)i elapsed:(NSTimeInterval)elapsed duration:(CGFloat)duration complete:(BOOL *)outComplete {
-    if (elapsed >= duration) {
-        *outComplete = YES;
-        return 1.0;
-    } else {
-        *outComplete = NO;
-        return 0.0;
-    }
+- (void)didChange {
+    _mutations += 1;
 }
 
-- (CGFloat)simulateIndex:(NSUInteger)i elapsed:(NSTimeInterval)elapsed velocity:(CGFloat)velocity complete:(BOOL *)outComplete {
+// The math is in the portable core (see Core/); these just convert to and from
+// the arrays of components used by animations.
+
+- (void)simulateCount:(NSUInteger)count elapsed:(NSTimeInterval)elapsed durations:(const double *)durations fromComponents:(const double *)from toComponents:(const double *)to positions:(double *)positions complete:(BOOL *)outComplete {
+    bool complete = false;
+    XNCoreStepEvaluateBatch(count, elapsed, durations, from, to, positions, &complete);
+    *outComplete = complete;
+}
+
+- (void)simulateCount:(NSUInteger)count elapsed:(NSTimeInterval)elapsed velocities:(const double *)velocities fromComponents:(const double *)from toComponents:(const double *)to restDistance:(CGFloat)restDistance restVelocity:(CGFloat)restVelocity positions:(double *)positions complete:(BOOL *)outComplete {
+    memcpy(positions, to, (sizeof(double) * count));
     *outComplete = YES;
-    return 1.0;
 }
 
-- (NSArray *)simulateWithTimeInterval:(NSTimeInterval)dt elapsed:(NSTimeInterval)elapsed durations:(NSArray *)durations velocities:(NSArray *)velocities fromComponents:(NSArray *)fromComponents toComponents:(NSArray *)toComponents complete:(BOOL *)outComplete {
-    if ((fromComponents == nil || fromComponents == nil) || (velocities == nil && durations == nil)) {
+- (NSArray *)simulateWithTimeInterval:(NSTimeInterval)dt elapsed:(NSTimeInterval)elapsed durations:(NSArray *)durations velocities:(NSArray *)velocities fromComponents:(NSArray *)fromComponents toComponents:(NSArray *)toComponents restDistance:(CGFloat)restDistance restVelocity:(CGFloat)restVelocity complete:(BOOL *)outComplete {
+    if ((fromComponents == nil || toComponents == nil) || (velocities == nil && durations == nil)) {
         [NSException raise:@"XNTimingFunctionMissingComponentsException" format:@"from, to, and duration/velocity must be provided"];
     }
 
@@ -45,48 +54,46 @@
         [NSException raise:@"XNTimingFunctionVariableDimensionsException" format:@"from, to, and duration/velocity must all be of the same dimensions"];
     }
 
-    NSMutableArray *positions = [NSMutableArray array];
-    if (outComplete != NULL) {
-        *outComplete = YES;
-    }
+    NSUInteger count = [fromComponents count];
 
-    for (NSUInteger i = 0; i < [fromComponents count]; i++) {
-        NSNumber *fromValue = [fromComponents objectAtIndex:i];
-        NSNumber *toValue = [toComponents objectAtIndex:i];
-        
-        CGFloat from = [fromValue floatValue];
-        CGFloat to = [toValue floatValue];
-        CGFloat range = (to - from);
-
-        BOOL complete = NO;
-        CGFloat position = 0;
-
-        NSNumber *velocityValue = [velocities objectAtIndex:i];
-        NSNumber *durationValue = [durations objectAtIndex:i];
-
-        if (velocityValue != nil) {
-            CGFloat velocity = [velocityValue floatValue];
-            velocity = velocity / range;
-            if (range == 0) velocity = 0;
-            position = [self simulateIndex:i elapsed:elapsed velocity:velocity complete:&complete];
-        } else if (durationValue != nil) {
-            CGFloat duration = [durationValue floatValue];
-            position = [self simulateIndex:i elapsed:elapsed duration:duration complete:&complete];
+    double from[count];
+    double to[count];
+    double rates[count];
+    double positions[count];
+
+    for (NSUInteger i = 0; i < count; i++) {
+        from[i] = [[fromComponents objectAtIndex:i] doubleValue];
+        to[i] = [[toComponents objectAtIndex:i] doubleValue];
+
+        if (velocities != nil) {
+            rates[i] = [[velocities objectAtIndex:i] doubleValue];
+        } else {
+            rates[i] = [[durations objectAtIndex:i] doubleValue];
         }
+    }
+
+    BOOL complete = NO;
+
+    if (velocities != nil) {
+        [self simulateCount:count elapsed:elapsed velocities:rates fromComponents:from toComponents:to restDistance:restDistance restVelocity:restVelocity positions:positions complete:&complete];
+    } else {
+        [self simulateCount:count elapsed:elapsed durations:rates fromComponents:from toComponents:to positions:positions complete:&complete];
+    }
 
-        position = from + position * range;
+    if (outComplete != NULL) {
+        *outComplete = complete;
+    }
 
-        NSAssert(!isnan(position), @"position cannot be NaN");
+    NSMutableArray *result = [NSMutableArray arrayWithCapacity:count];
 
-        if (outComplete != NULL) {
-            *outComplete = (*outComplete && complete);
-        }
+    for (NSUInteger i = 0; i < count; i++) {
+        NSAssert(!isnan(positions[i]), @"position cannot be NaN");
 
-        NSNumber *positionValue = [NSNumber numberWithFloat:position];
-        [positions addObject:positionValue];
+        NSNumber *positionValue = [NSNumber numberWithDouble:positions[i]];
+        [result addObject:positionValue];
     }
     
-    return positions;
+    return result;
 }
 
 @end
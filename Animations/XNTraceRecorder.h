@@ -0,0 +1,43 @@
+//
+//  XNTraceRecorder.h
+//  Animations
+//
+//  Created by Grant Paul on 1/12/13.
+//  Copyright (c) 2013 Xuzz Productions, LLC. All rights reserved.
+//
+
+#import "XNCoreTrace.h"
+
+@class XNScrollView;
+
+// Trace format: a header, then a stream of records, as described and read by
+// XNCoreTrace.h.
+extern const uint32_t XNTraceVersion;
+
+enum {
+    XNTraceRecordTypeGeometry = XNCoreTraceRecordTypeGeometry,
+    XNTraceRecordTypePan = XNCoreTraceRecordTypePan,
+    XNTraceRecordTypeTick = XNCoreTraceRecordTypeTick,
+    XNTraceRecordTypeConfiguration = XNCoreTraceRecordTypeConfiguration
+};
+
+typedef uint8_t XNTraceRecordType;
+
+// Records pan events on one scroll view, along with every animation tick,
+// for replaying later with XNTraceReplayer. Only one recorder can be active.
+@interface XNTraceRecorder : NSObject
+
++ (XNTraceRecorder *)activeRecorder; // nil if not recording
+
+- (id)initWithScrollView:(XNScrollView *)scrollView;
+@property (nonatomic, assign, readonly) XNScrollView *scrollView;
+
+- (void)start;
+- (NSData *)stop; // returns the trace
+
+- (void)recordConfigurationWithTimestamp:(NSTimeInterval)timestamp; // of the scroll view and screen
+- (void)recordGeometryWithBounds:(CGRect)bounds contentSize:(CGSize)contentSize contentInset:(UIEdgeInsets)contentInset timestamp:(NSTimeInterval)timestamp;
+- (void)recordPanWithState:(UIGestureRecognizerState)state translation:(CGPoint)translation timestamp:(NSTimeInterval)timestamp;
+- (void)recordTickWithTimestamp:(NSTimeInterval)timestamp;
+
+@end
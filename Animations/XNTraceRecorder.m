@@ -0,0 +1,139 @@
+//
+//  XNTraceRecorder.m
+//  Animations
+//
+//  Created by Grant Paul on 1/12/13.
+//  Copyright (c) 2013 Xuzz Productions, LLC. All rights reserved.
+//
+
+#import <QuartzCore/QuartzCore.h>
+
+#import "XNTraceRecorder.h"
+#import "XNScrollView.h"
+
+const uint32_t XNTraceVersion = XNCoreTraceVersion;
+
+static XNTraceRecorder *XNTraceRecorderActiveRecorder = nil;
+
+@implementation XNTraceRecorder {
+    XNScrollView *_scrollView;
+    NSMutableData *_trace;
+}
+
+@synthesize scrollView = _scrollView;
+
++ (XNTraceRecorder *)activeRecorder {
+    return XNTraceRecorderActiveRecorder;
+}
+
+- (id)initWithScrollView:(XNScrollView *)scrollView {
+    if ((self = [super init])) {
+        _scrollView = scrollView;
+    }
+
+    return self;
+}
+
+- (void)dealloc {
+    if (XNTraceRecorderActiveRecorder == self) {
+        XNTraceRecorderActiveRecorder = nil;
+    }
+
+    [_trace release];
+
+    [super dealloc];
+}
+
+- (void)start {
+    if (XNTraceRecorderActiveRecorder != nil) {
+        [NSException raise:@"XNTraceRecorderAlreadyRecordingException" format:@"only one recorder can be active at a time"];
+    }
+
+    XNTraceRecorderActiveRecorder = self;
+
+    [_trace release];
+    _trace = [[NSMutableData alloc] init];
+
+    [_trace appendBytes:"XNTR" length:4];
+    [_trace appendBytes:&XNTraceVersion length:sizeof(XNTraceVersion)];
+
+    // Replays start from wherever the scroll view was when recording began,
+    // with the same physics.
+    NSTimeInterval timestamp = CACurrentMediaTime();
+    [self recordConfigurationWithTimestamp:timestamp];
+    [self recordGeometryWithBounds:[_scrollView bounds] contentSize:[_scrollView contentSize] contentInset:[_scrollView contentInset] timestamp:timestamp];
+}
+
+- (NSData *)stop {
+    if (XNTraceRecorderActiveRecorder == self) {
+        XNTraceRecorderActiveRecorder = nil;
+    }
+
+    NSData *trace = [[_trace copy] autorelease];
+
+    [_trace release];
+    _trace = nil;
+
+    return trace;
+}
+
+#pragma mark - Records
+
+- (void)appendType:(XNTraceRecordType)type timestamp:(NSTimeInterval)timestamp {
+    double time = timestamp;
+
+    [_trace appendBytes:&type length:sizeof(type)];
+    [_trace appendBytes:&time length:sizeof(time)];
+}
+
+- (void)appendFloats:(const float *)floats count:(NSUInteger)count {
+    [_trace appendBytes:floats length:(sizeof(float) * count)];
+}
+
+- (void)recordConfigurationWithTimestamp:(NSTimeInterval)timestamp {
+    [self appendType:XNTraceRecordTypeConfiguration timestamp:timestamp];
+
+    // The elastic constants aren't configurable, but can change from build
+    // to build; the model has them as the scroll view does.
+    XNCoreScroll scroll;
+    [XNScrollView _initializeScrollModel:&scroll];
+
+    uint8_t flags = 0;
+    flags |= ([_scrollView bounces] ? XNCoreTraceFlagBounces : 0);
+    flags |= ([_scrollView alwaysBounceHorizontal] ? XNCoreTraceFlagAlwaysBounceHorizontal : 0);
+    flags |= ([_scrollView alwaysBounceVertical] ? XNCoreTraceFlagAlwaysBounceVertical : 0);
+    flags |= ([_scrollView predictsTouches] ? XNCoreTraceFlagPredictsTouches : 0);
+    flags |= (scroll.elasticSimpleFormula ? XNCoreTraceFlagElasticSimpleFormula : 0);
+    [_trace appendBytes:&flags length:sizeof(flags)];
+
+    float values[3] = { [_scrollView decelerationRate], scroll.elasticConstant, [[UIScreen mainScreen] scale] };
+    [self appendFloats:values count:3];
+}
+
+- (void)recordGeometryWithBounds:(CGRect)bounds contentSize:(CGSize)contentSize contentInset:(UIEdgeInsets)contentInset timestamp:(NSTimeInterval)timestamp {
+    [self appendType:XNTraceRecordTypeGeometry timestamp:timestamp];
+
+    float values[10] = {
+        bounds.origin.x, bounds.origin.y, bounds.size.width, bounds.size.height,
+        contentSize.width, contentSize.height,
+        contentInset.top, contentInset.left, contentInset.bottom, contentInset.right
+    };
+
+    [self appendFloats:values count:10];
+}
+
+- (void)recordPanWithState:(UIGestureRecognizerState)state translation:(CGPoint)translation timestamp:(NSTimeInterval)timestamp {
+    [self appendType:XNTraceRecordTypePan timestamp:timestamp];
+
+    uint8_t recordedState = state;
+    [_trace appendBytes:&recordedState length:sizeof(recordedState)];
+
+    float values[2] = { translation.x, translation.y };
+    [self appendFloats:values count:2];
+}
+
+- (void)recordTickWithTimestamp:(NSTimeInterval)timestamp {
+    [self appendType:XNTraceRecordTypeTick timestamp:timestamp];
+}
+
+@end
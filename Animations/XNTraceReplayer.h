@@ -0,0 +1,30 @@
+//
+//  XNTraceReplayer.h
+//  Animations
+//
+//  Created by Grant Paul on 1/12/13.
+//  Copyright (c) 2013 Xuzz Productions, LLC. All rights reserved.
+//
+
+// One simulated frame of a replayed trace.
+@interface XNTraceReplayFrame : NSObject
+
+@property (nonatomic, assign, readonly) NSTimeInterval timestamp; // from the trace
+@property (nonatomic, assign, readonly) CGPoint contentOffset; // after the frame
+@property (nonatomic, assign, readonly) NSTimeInterval simulationDuration; // wall time spent simulating
+
+@end
+
+// Replays a trace from XNTraceRecorder through the scroll physics, without a
+// scroll view or the display link: the physics are configured as recorded,
+// deceleration is stepped with the recorded frame timing, and touches are
+// predicted from the time of each event. The result is the same for the same
+// trace, so it can be compared across changes.
+@interface XNTraceReplayer : NSObject
+
+- (id)initWithTrace:(NSData *)trace;
+
+// Returns an array of XNTraceReplayFrame, one per recorded tick after the first.
+- (NSArray *)replay;
+
+@end
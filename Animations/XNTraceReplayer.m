@@ -0,0 +1,110 @@
+//
+//  XNTraceReplayer.m
+//  Animations
+//
+//  Created by Grant Paul on 1/12/13.
+//  Copyright (c) 2013 Xuzz Productions, LLC. All rights reserved.
+//
+
+#import <QuartzCore/QuartzCore.h>
+
+#import "XNTraceReplayer.h"
+
+#import "XNCoreTrace.h"
+
+@interface XNTraceReplayFrame ()
+
+- (id)initWithTimestamp:(NSTimeInterval)timestamp contentOffset:(CGPoint)contentOffset simulationDuration:(NSTimeInterval)simulationDuration;
+
+@end
+
+@implementation XNTraceReplayFrame {
+    NSTimeInterval _timestamp;
+    CGPoint _contentOffset;
+    NSTimeInterval _simulationDuration;
+}
+
+@synthesize timestamp = _timestamp;
+@synthesize contentOffset = _contentOffset;
+@synthesize simulationDuration = _simulationDuration;
+
+- (id)initWithTimestamp:(NSTimeInterval)timestamp contentOffset:(CGPoint)contentOffset simulationDuration:(NSTimeInterval)simulationDuration {
+    if ((self = [super init])) {
+        _timestamp = timestamp;
+        _contentOffset = contentOffset;
+        _simulationDuration = simulationDuration;
+    }
+
+    return self;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@:%p timestamp = %f offset = %@ simulation = %f>", [self class], self, _timestamp, NSStringFromCGPoint(_contentOffset), _simulationDuration];
+}
+
+@end
+
+@implementation XNTraceReplayer {
+    NSData *_trace;
+}
+
+- (id)initWithTrace:(NSData *)trace {
+    if ((self = [super init])) {
+        _trace = [trace copy];
+    }
+
+    return self;
+}
+
+- (void)dealloc {
+    [_trace release];
+
+    [super dealloc];
+}
+
+#pragma mark - Replaying
+
+- (void)checkStatus:(XNCoreTraceStatus)status reader:(XNCoreTraceReader *)reader {
+    if (status == XNCoreTraceStatusTruncated) {
+        [NSException raise:@"XNTraceReplayerTruncatedTraceException" format:@"trace ended inside a record at %lu", (unsigned long) reader->position];
+    } else if (status == XNCoreTraceStatusInvalid) {
+        [NSException raise:@"XNTraceReplayerInvalidTraceException" format:@"not a trace, an unsupported version, or an unknown record at %lu", (unsigned long) reader->position];
+    }
+}
+
+- (NSArray *)replay {
+    NSMutableArray *frames = [NSMutableArray array];
+
+    // Configured by the trace.
+    XNCoreScroll scroll;
+    XNCoreScrollInit(&scroll);
+
+    XNCoreTraceReplay replay;
+    XNCoreTraceReplayInit(&replay, &scroll);
+
+    XNCoreTraceReader reader;
+    XNCoreTraceStatus status = XNCoreTraceReaderInit(&reader, [_trace bytes], [_trace length]);
+    [self checkStatus:status reader:&reader];
+
+    XNCoreTraceRecord record;
+
+    while ((status = XNCoreTraceReaderNext(&reader, &record)) == XNCoreTraceStatusRecord) {
+        NSTimeInterval start = CACurrentMediaTime();
+        BOOL frame = XNCoreTraceReplayRecord(&replay, &record);
+        NSTimeInterval duration = CACurrentMediaTime() - start;
+
+        if (frame) {
+            CGPoint contentOffset = CGPointMake(scroll.contentOffset.x, scroll.contentOffset.y);
+
+            XNTraceReplayFrame *replayFrame = [[XNTraceReplayFrame alloc] initWithTimestamp:record.timestamp contentOffset:contentOffset simulationDuration:duration];
+            [frames addObject:replayFrame];
+            [replayFrame release];
+        }
+    }
+
+    [self checkStatus:status reader:&reader];
+
+    return frames;
+}
+
+@end